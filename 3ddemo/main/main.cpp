@@ -16,35 +16,52 @@ class Graphics3D : public application::Application {
     }
 
     void init() override {
-        setPeriod(40);                                          // set 40 ms cycle / 25 fps
+        setPeriod(40);                                          // set 40 ms simulation step / 25 Hz
+        setPacing(PACING_ADAPTIVE);                             // pace frames to the panel refresh
         showStatistics(false);                                  // disable statistics overlay (default)
 
         createMesh();                                           // create 3D mesh
 
         auto display = getDisplay();                            // get display reference
 
+        display->device()->setRefreshMode(graphics::RefreshMode::ScanSynchronized); // no page half updated
         display->setBuiltinFont(1);                             // set font
         display->clear();                                       // clear display
         display->update(true);                                  // update display
 
         renderer_.init(display);                                // initialize renderer
+
+#ifdef SIMULATOR
+        renderer_.openStatsLog("render_stats.csv");             // dump renderer statistics per frame
+#endif
     }
 
     void update() override {
+        auto delta = this->getDelta();                          // fixed simulation step
+        mesh_.rotate({1.23f*delta, 2.47f*delta, 0.0f});         // update rotation angles
+        mesh_.animate(delta);                                   // advance keyframe animation
+    }
+
+    void render() override {
         auto display = getDisplay();                            // get display reference
         display->clear();                                       // clear display (ignore locked areas)
 
-        auto delta = this->getDelta();
-        mesh_.rotate({1.23f*delta, 2.47f*delta, 0.0f});         // update rotation angles
         renderer_.drawMesh(&mesh_, false);                       // draw 3D mesh
         renderer_.update();                                     // update render buffers
 
         display->update();                                      // update screen
     }
 
+    void formatOverlay(graphics::Formatter& text) override {
+        Application::formatOverlay(text);                       // application statistics
+        text.append('/');
+        renderer_.stats().format(text);                         // vertices/triangles/culled/time
+    }
+
     void createMesh() {
-        mesh_.setVertices(vertices);
-        mesh_.setFaces(faces);
+        mesh_.setPackedData(&mesh_data);
+        mesh_.setLevels(levels, num_levels);
+        mesh_.setAnimation(animation);
         mesh_.setPosition({ 0.0f, 0.0f, 0.0f });
         mesh_.setScale({ 1.0f, 1.0f, 1.0f });
         mesh_.setRotation({ 0.0f, 0.0f, 0.0f });
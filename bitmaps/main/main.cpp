@@ -20,35 +20,34 @@ class BitmapDemo : public application::Application {
     void init() {
         setPeriod(25);
         auto display = getDisplay();
-        display->setPartialUpdate(false);
         display->clear();
+        display->drawBitmap(&background_bitmap, 0, 0, false);  // static background, drawn once
+
+        sprite_ = display->sprites().create(sprite_frames_, 1);
     }
 
     void update() {
         auto display = getDisplay();
 
-        display->clear();
-        display->fillRectangle(0, 0, 128, 64);
-
         w = fmod(w + getDelta() * 4.0, PI2);
         auto x = 20.0 * cos(w);
         auto y = 20.0 * sin(w);
 
-        const auto& background = background_bitmap;
-
-        display->drawBitmap(&background, 0, 0, false);
-
         const auto& bitmap = hello_bitmap;
-        display->drawBitmap(
-            &bitmap,
+        display->sprites().setPosition(
+            sprite_,
             (int) x, // ((display->width() - bitmap.width) / 2 + (int) x),
             (display->height() - bitmap.height()) / 2 + (int) y);
 
+        display->sprites().update();    // restore background, redraw at new position
+
         display->update();
     }
 
    private:
     double w{0.0};
+    int sprite_{-1};
+    const Bitmap* sprite_frames_[1] = { &hello_bitmap };
 
     _NODEFAULTS(BitmapDemo)
 };
@@ -23,7 +23,10 @@ const int num_bitmaps = sizeof(bitmaps) / sizeof(bitmaps[0]);
 class BoingBall : public application::Application {
    public:
     explicit BoingBall()
-        : Application() {}
+        : Application(),
+          background_(128, 64),
+          ball_(bitmaps[0]->width(), bitmaps[0]->height()),
+          ball_mask_(bitmaps[0]->width(), bitmaps[0]->height()) {}
 
     void init() {
         LOG_INFO("app", "Boing ball demo - inspired by Amiga CES Demo 1984!");
@@ -46,17 +49,41 @@ class BoingBall : public application::Application {
         state_.max_y = (float) (display->height() - bitmap->height());
 
         display->clear();                                   // clear display
+
+        display->setLayer(&background_);                    // draw static background once
+        drawGrid(display);
+        display->setLayer(nullptr);
+
+        ball_.setMask(&ball_mask_);                         // ball covers the grid within its outline
+        compositor_.addLayer(&background_);
+        compositor_.addLayer(&ball_);
     }
 
     void update() {
         auto display = getDisplay();                       // get display reference
 
+        updateState(getDelta());                            // update ball state
+
+        int frame = (int)state_.a;
+        if (frame != ball_frame_) {                         // redraw ball layer on animation change
+            ball_frame_ = frame;
+            drawBall(display, bitmaps[frame]);
+        }
+
+        ball_.setPosition((int)state_.x, (int)state_.y);   // moving marks old and new area
+
+        // only pages touched by the ball are recomposited and refreshed
+        if (compositor_.compose(display->device())) {
+            display->update();                             // refresh display
+        }
+    }
+
+   private:
+    void drawGrid(graphics::Display* display) {
         auto w = display->width();
         auto h = display->height();
 
-        display->clear();                                   // clear display
-
-        // draw background grid
+        display->clear();
         display->drawHorizontalLine(8, 58, w-8);
         display->drawHorizontalLine(6, 61, w-6);
         for (int y = h-9; y >= 0; y -= 11) {
@@ -68,29 +95,22 @@ class BoingBall : public application::Application {
             display->drawVerticalLine(w / 2 + i * 11, 0, h-9);
             display->drawLine(w / 2 + i * 11, h-9, w / 2 + i * 12, h-1);
         }
+    }
 
-        if (0 != getUpdateCounter()) {
-            // Don't completely redraw after first update
-            // updating the display is the most time-consuming part!!
-            display->device()->clearRegions();
-        }
-
-        auto bitmap = bitmaps[(int)state_.a];               // get bitmap data
-
-        // mark old ball position to fix and refresh the background
-        display->device()->markRegion((uint8_t)state_.x,
-                                      (uint8_t)state_.x + bitmap->width(),
-                                      (uint8_t)state_.y,
-                                      (uint8_t)state_.y + bitmap->height());
-
-        updateState(getDelta());                            // update ball state
+    void drawBall(graphics::Display* display, const graphics::Bitmap* bitmap) {
+        display->setLayer(&ball_);
+        display->clear();
+        display->drawBitmap(bitmap, 0, 0);
 
-        display->drawBitmap(bitmap, (uint8_t)state_.x, (uint8_t)state_.y);
+        display->setLayer(&ball_mask_);                     // outline: alpha pixels on
+        display->clear();
+        auto old_background = display->setBackground(graphics::WHITE);
+        display->drawBitmap(bitmap, 0, 0);
+        display->setBackground(old_background);
 
-        display->update();                                 // refresh display
+        display->setLayer(nullptr);
     }
 
-   private:
     void updateState(float delta_time) {
         state_.x += state_.vx * delta_time;                 // update x-pos
         if (state_.x < 0.0f) {
@@ -141,6 +161,12 @@ class BoingBall : public application::Application {
 
     state_t state_;
 
+    graphics::Layer background_;                            // static grid
+    graphics::Layer ball_;                                  // current ball frame
+    graphics::Layer ball_mask_;                             // ball outline
+    graphics::Compositor compositor_;
+    int ball_frame_{-1};
+
     _NODEFAULTS(BoingBall)
 };
 
@@ -3,19 +3,32 @@
 //
 
 #include "application/application.h"
+#include "graphics/graphics.h"
 
 class Hello : public application::Application {
    public:
     explicit Hello() : Application() {}
 
     void init() override {
+        setPeriod(250);                                     // log four times per second
+
+        console_.setHardwareScroll(true);                   // scroll with the display start line
+        graphics::Console::attachLog(&console_);            // mirror log output on the display
+
         LOG_INFO("app", "Hello, world!");
     }
 
     void update() override {
         LOG_INFO("app", "Hello, world! (%d)", getUpdateCounter());
+
+        auto display = getDisplay();
+        console_.draw(display->device());                   // draw new characters only
+        display->update();
     }
 
+   private:
+    graphics::Console console_;
+
     _NODEFAULTS(Hello)
 };
 
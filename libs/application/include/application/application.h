@@ -6,9 +6,11 @@
 #include <cstdint>
 
 #include "application/bits.h"
+#include "application/profiler.h"
 
 namespace graphics {
 class Display;
+class Formatter;
 }
 
 namespace application {
@@ -21,12 +23,26 @@ template <typename T> void ApplicationEntry();
  */
 class Application {
 
+   public:
+    /**
+     * Main loop pacing.
+     * PACING_FIXED runs update/render once per period on the tick grid.
+     * PACING_ADAPTIVE paces frames to the panel refresh, runs update() with
+     * a fixed timestep of one period and skips render/refresh work that
+     * would miss the frame deadline.
+     */
+    enum PacingMode {
+        PACING_FIXED = 0,
+        PACING_ADAPTIVE
+    };
+
    public:
     explicit Application();
 
    public:
     virtual void init();
     virtual void update();
+    virtual void render();
 
    public:
     virtual void taskRun();
@@ -34,6 +50,9 @@ class Application {
    private:
     virtual void taskInit();
     virtual void taskLoop();
+    void runFixed();
+    void runAdaptive();
+    void updateStatistics(uint32_t elapsed_time_ms);
 
    public:
     virtual void exit(int exit_code);
@@ -56,13 +75,35 @@ class Application {
     float getTime() const;
     float getDelta() const;
 
+    void setPacing(PacingMode pacing);
+    PacingMode getPacing() const;
+    float getInterpolation() const;
+
    protected:
     uint32_t getAvgCycleTime() const;
     uint32_t getAvgUpdatesPerSecond() const;
     void showStatistics(bool show);
+    bool isShowingStatistics() const;
+    const Profiler& getProfiler() const;
 
    protected:
-    void renderOverlay();
+    /**
+     * @brief   Draw the statistics into the bottom page. The page is locked
+     *          and only re-rendered and transferred when the values change.
+     */
+    virtual void renderOverlay();
+
+    /**
+     * @brief   Format the overlay text, called once per statistics interval.
+     *          The overlay shows digits and '/', other characters leave a gap.
+     * @param   text    Formatter to append to
+     */
+    virtual void formatOverlay(graphics::Formatter& text);
+
+   private:
+    bool updateOverlayText();
+    void renderOverlayPage(int width);
+    void releaseOverlay();
 
    private:
     bool running_{false};
@@ -73,7 +114,24 @@ class Application {
     uint32_t update_counter_{0};
     uint32_t avg_cycle_time_ms_{0};
     uint32_t avg_updates_per_sec_{0};
+    uint32_t statistics_time_ms_{0};
+    uint32_t statistics_frame_counter_{0};
+    uint32_t statistics_value_counter_{0};
+    PacingMode pacing_{PACING_FIXED};
+    float interpolation_{0.0f};
+    int frame_divisor_{1};
+    uint32_t skipped_renders_{0};
+    uint32_t skipped_refreshes_{0};
+    uint32_t dropped_steps_{0};
     bool show_stats_{false};
+    static const int MAX_OVERLAY_WIDTH = 128;
+    static const int MAX_OVERLAY_TEXT = 32;
+    uint8_t overlay_[MAX_OVERLAY_WIDTH]{};              // cached overlay page
+    char overlay_text_[MAX_OVERLAY_TEXT]{};             // text of the cached page
+    int overlay_page_{-1};                              // reserved (locked) page, -1 if none
+    bool overlay_pending_{true};                        // statistics updated, format again
+    bool overlay_valid_{false};                         // cached page matches the panel
+    Profiler profiler_;
     graphics::Display* display_{nullptr};
     int exit_code_{0};
 
@@ -0,0 +1,90 @@
+//
+// Component
+//
+#pragma once
+
+#include <cstdint>
+
+#include "application/bits.h"
+#include "graphics/base.h"
+
+namespace graphics {
+class Display;
+}
+
+namespace application {
+
+class Scheduler;
+
+/**
+ * Display component run by a Scheduler. Components share one display,
+ * each one updates at its own period and draws into its own region.
+ * Components with a higher layer are drawn on top.
+ */
+class Component {
+
+   public:
+    explicit Component();
+
+   public:
+    virtual void init();
+    virtual void update();
+    virtual void render();
+
+   public:
+    void setPeriod(uint32_t period_ms);
+    uint32_t getPeriod() const;
+
+    void setRegion(int x, int y, int x2, int y2);
+    const graphics::Rectangle& getRegion() const;
+
+    void setLayer(int layer);
+    int getLayer() const;
+
+    void setOpaque(bool opaque);
+    bool isOpaque() const;
+
+    /**
+     * @brief   Let render() mark the parts it changed itself. The region is
+     *          then neither cleared nor marked dirty as a whole.
+     */
+    void setPartialRender(bool enable);
+    bool isPartialRender() const;
+
+    void invalidate();
+    bool isInvalid() const;
+
+    /**
+     * @brief   Render after every update (default). Disable it for
+     *          components that call invalidate() when their content changes.
+     */
+    void setAutoInvalidate(bool enable);
+    bool isAutoInvalidate() const;
+
+   protected:
+    graphics::Display* getDisplay();
+    uint32_t getUpdateCounter() const;
+    uint32_t getDeltaMillis() const;
+    float getDelta() const;
+
+   private:
+    friend class Scheduler;
+
+    graphics::Display* display_{nullptr};
+    graphics::Rectangle region_;
+    uint32_t period_ms_{100};
+    int layer_{0};
+    bool opaque_{true};         // region is cleared before render()
+    bool partial_render_{false};    // render() marks its own changes
+    bool invalid_{true};        // render() pending
+    bool auto_invalidate_{true};
+    int64_t next_update_us_{0};
+    int64_t last_update_us_{0};
+    uint32_t delta_time_ms_{0};
+    uint32_t update_counter_{0};
+
+   public:
+    _NODEFAULTS(Component);
+};
+
+}  // namespace application
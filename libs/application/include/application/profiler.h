@@ -0,0 +1,79 @@
+//
+// Profiler
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "application/bits.h"
+
+namespace application {
+
+/**
+ * Frame profiler. Samples stage times with microsecond resolution
+ * and keeps the last frames in a fixed ring buffer.
+ */
+class Profiler {
+
+   public:
+    enum Stage {
+        STAGE_UPDATE = 0,
+        STAGE_RENDER,
+        STAGE_OVERLAY,
+        STAGE_REFRESH,
+        STAGE_FRAME,    ///< sum of all stages
+        NUM_STAGES
+    };
+
+    static const size_t HISTORY_SIZE = 128;
+
+    /**
+     * Timing statistics of a stage over the history
+     */
+    struct StageStats {
+        uint32_t min_us{0};
+        uint32_t avg_us{0};
+        uint32_t p95_us{0};
+        uint32_t p99_us{0};
+        uint32_t max_us{0};
+    };
+
+   public:
+    explicit Profiler();
+
+   public:
+    void reset();
+    void setDeadline(uint32_t deadline_us);
+    void beginFrame();
+    void endStage(Stage stage);
+    void endFrame();
+
+   public:
+    size_t numFrames() const;
+    uint32_t sample(Stage stage, size_t age) const;
+    StageStats stats(Stage stage) const;
+    uint32_t missedDeadlines() const;
+    uint32_t missedDeadlinesInHistory() const;
+    static const char* stageName(Stage stage);
+
+   private:
+    static int64_t now();
+
+   private:
+    uint32_t samples_[HISTORY_SIZE][NUM_STAGES];
+    bool missed_[HISTORY_SIZE];
+    uint32_t current_[NUM_STAGES];
+    size_t head_{0};
+    size_t count_{0};
+    int64_t frame_start_{0};
+    int64_t stage_start_{0};
+    uint32_t deadline_us_{0};
+    uint32_t missed_deadlines_{0};
+    mutable uint32_t scratch_[HISTORY_SIZE];  ///< percentile selection without heap
+
+   public:
+    _NODEFAULTS(Profiler);
+};
+
+}  // namespace application
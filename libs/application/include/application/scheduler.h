@@ -0,0 +1,44 @@
+//
+// Scheduler
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "application/application.h"
+#include "application/component.h"
+
+namespace application {
+
+/**
+ * Cooperative component scheduler. Runs the update() of each component
+ * when its period is due, then redraws the invalid components in layer
+ * order and merges their regions into a single display refresh per frame.
+ */
+class Scheduler : public Application {
+
+   public:
+    static const size_t MAX_COMPONENTS = 8;
+
+   public:
+    explicit Scheduler();
+
+   public:
+    void update() override;
+    void render() override;
+
+   protected:
+    bool addComponent(Component* component);
+    size_t numComponents() const;
+    Component* getComponent(size_t index);
+
+   private:
+    Component* components_[MAX_COMPONENTS];     // sorted by layer
+    size_t num_components_{0};
+
+   public:
+    _NODEFAULTS(Scheduler);
+};
+
+}  // namespace application
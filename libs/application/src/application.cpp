@@ -5,7 +5,11 @@
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "esp_timer.h"
 #include "graphics/graphics.h"
+#include "sys/trace.h"
+
+#include <cstring>
 
 #include "data.inc"
 
@@ -77,6 +81,8 @@ void Application::init() {}
 
 void Application::update() {}
 
+void Application::render() {}
+
 void Application::taskRun() {
     ESP_LOGI(TAG, "main task started");
 
@@ -140,86 +146,362 @@ void Application::taskLoop() {
     ESP_LOGV(TAG, "application::task_loop()");
 
     running_ = true;
+    update_counter_ = 0;
+
+    statistics_time_ms_ = getMillis();
+    statistics_frame_counter_ = 0;
+    statistics_value_counter_ = 0;
+
+    ESP_LOGI(TAG, "tick period ms: %d", (int) (portTICK_PERIOD_MS));
+    ESP_LOGI(TAG, "task period ms: %d", (int) getPeriod());
+
+    if (PACING_ADAPTIVE == pacing_) {
+        runAdaptive();
+    } else {
+        runFixed();
+    }
+
+    running_ = false;
+}
+
+void Application::runFixed() {
 
     uint32_t cycle_time_ms = getPeriod();
     uint32_t start_time_ms = getMillis();
-    update_counter_ = 0;
-
-    uint32_t statistics_time_ms = start_time_ms;
-    uint32_t statistics_cycle_time_ms = 5000;
-    uint32_t statistics_frame_counter = 0;
-    uint32_t statistics_value_counter = 0;
+    uint32_t last_start_time_ms = start_time_ms;
 
     TickType_t activation_tick = xTaskGetTickCount();
     TickType_t activation_tick_inc = cycle_time_ms / portTICK_PERIOD_MS;
     if (activation_tick_inc < 1) activation_tick_inc = 1;
 
-    ESP_LOGI(TAG, "tick period ms: %d", (int) (portTICK_PERIOD_MS));
-    ESP_LOGI(TAG, "task period ms: %d", (int) cycle_time_ms);
-
-    uint32_t last_update_ms = start_time_ms;
+    profiler_.reset();
+    profiler_.setDeadline(cycle_time_ms * 1000);
 
     while (true == running_ && false == error_) {
-        delta_time_ms_ = (start_time_ms - last_update_ms);
-        last_update_ms = start_time_ms;
         start_time_ms = getMillis();
-        update();
-        renderOverlay();
-        if (display_->getDeferredUpdate()) {
-            display_->refresh();
+        delta_time_ms_ = (start_time_ms - last_start_time_ms);
+        last_start_time_ms = start_time_ms;
+
+        {
+            TRACE_SCOPE("app.frame");
+
+            profiler_.beginFrame();
+            update();
+            profiler_.endStage(Profiler::STAGE_UPDATE);
+            render();
+            profiler_.endStage(Profiler::STAGE_RENDER);
+            renderOverlay();
+            profiler_.endStage(Profiler::STAGE_OVERLAY);
+            if (display_->getDeferredUpdate()) {
+                display_->refresh();
+            }
+            profiler_.endStage(Profiler::STAGE_REFRESH);
+            profiler_.endFrame();
         }
 
         if (false == running_ || true == error_) break;
-        uint32_t now = getMillis();
-        uint32_t elapsed_time_ms = now - start_time_ms;
+        uint32_t elapsed_time_ms = getMillis() - start_time_ms;
 
-        // ESP_LOGI(TAG, "elapsed: %d", elapsed_time_ms);
         update_counter_++;
+        updateStatistics(elapsed_time_ms);
+
+        vTaskDelayUntil(&activation_tick, activation_tick_inc);
+    }
+}
+
+void Application::runAdaptive() {
+
+    static const int MAX_UPDATE_STEPS = 4;      // max. simulation steps per frame
+    static const int MAX_FRAME_DIVISOR = 8;     // min. frame rate is panel rate / 8
+
+    // frames are paced to the panel refresh, simulation runs at the task period
+    float display_frequency = display_->device()->frequency();
+    int64_t panel_period_us = (display_frequency > 0.0f) ? (int64_t) (1000000.0f / display_frequency) : getPeriod() * 1000;
+    int64_t step_us = (int64_t) getPeriod() * 1000;
+    int64_t tick_us = (int64_t) portTICK_PERIOD_MS * 1000;
 
-        statistics_frame_counter++;
-        statistics_value_counter += (uint32_t)elapsed_time_ms;
-        if (now - statistics_time_ms >= statistics_cycle_time_ms) {
-            avg_cycle_time_ms_ = statistics_value_counter / statistics_frame_counter;
-            avg_updates_per_sec_ = (statistics_frame_counter * 1000) / (now - statistics_time_ms);
+    ESP_LOGI(TAG, "adaptive pacing, frame period us: %d, update step us: %d", (int) panel_period_us, (int) step_us);
 
-            ESP_LOGI(TAG, "avg. cycle time usage: %d/%d ms, updates/sec: %d",
-                     avg_cycle_time_ms_,
-                     cycle_time_ms,
-                     avg_updates_per_sec_);
+    delta_time_ms_ = getPeriod();   // update() always advances by the fixed step
+    frame_divisor_ = 1;
+    skipped_renders_ = 0;
+    skipped_refreshes_ = 0;
+    dropped_steps_ = 0;
 
-            statistics_time_ms = now;
-            statistics_frame_counter = 0;
-            statistics_value_counter = 0;
+    int64_t accumulator_us = 0;
+    int64_t avg_cost_us = 0;
+    int64_t avg_render_us = 0;
+    int64_t avg_refresh_us = 0;
+    bool refresh_pending = false;
+    bool skipped_render = false;
+    bool skipped_refresh = false;
+
+    int64_t last_time_us = esp_timer_get_time();
+    int64_t next_frame_us = last_time_us;
+
+    profiler_.reset();
+    profiler_.setDeadline((uint32_t) panel_period_us);
+
+    while (true == running_ && false == error_) {
+        TRACE_SCOPE("app.frame");
+
+        int64_t frame_start_us = esp_timer_get_time();
+        int64_t frame_period_us = panel_period_us * frame_divisor_;
+        int64_t deadline_us = frame_start_us + frame_period_us;
+
+        accumulator_us += frame_start_us - last_time_us;
+        last_time_us = frame_start_us;
+
+        profiler_.beginFrame();
+
+        // fixed timestep simulation, bounded to avoid falling further behind
+        int steps = 0;
+        while (accumulator_us >= step_us && steps < MAX_UPDATE_STEPS) {
+            update();
+            update_counter_++;
+            accumulator_us -= step_us;
+            steps++;
         }
 
-        vTaskDelayUntil(&activation_tick, activation_tick_inc);
+        if (accumulator_us >= step_us) {
+            dropped_steps_ += (uint32_t) (accumulator_us / step_us);
+            accumulator_us %= step_us;
+        }
+
+        interpolation_ = (float) accumulator_us / (float) step_us;
+
+        profiler_.endStage(Profiler::STAGE_UPDATE);
+
+        // render only changed state, skip if it would miss the deadline (never twice in a row)
+        if (steps > 0) {
+            int64_t t = esp_timer_get_time();
+            if (skipped_render || t + avg_render_us <= deadline_us) {
+                render();
+                profiler_.endStage(Profiler::STAGE_RENDER);
+                renderOverlay();
+                profiler_.endStage(Profiler::STAGE_OVERLAY);
+                refresh_pending = true;
+                skipped_render = false;
+                avg_render_us = (avg_render_us * 7 + (esp_timer_get_time() - t)) / 8;
+            } else {
+                skipped_render = true;
+                skipped_renders_++;
+            }
+        }
+
+        profiler_.endStage(Profiler::STAGE_RENDER);
+
+        // transfer to the panel, postpone if it would miss the deadline (never twice in a row)
+        if (refresh_pending && display_->getDeferredUpdate()) {
+            int64_t t = esp_timer_get_time();
+            if (skipped_refresh || t + avg_refresh_us <= deadline_us) {
+                display_->refresh();
+                refresh_pending = false;
+                skipped_refresh = false;
+                avg_refresh_us = (avg_refresh_us * 7 + (esp_timer_get_time() - t)) / 8;
+            } else {
+                skipped_refresh = true;
+                skipped_refreshes_++;
+            }
+        }
+
+        profiler_.endStage(Profiler::STAGE_REFRESH);
+        profiler_.endFrame();
+
+        if (false == running_ || true == error_) break;
+
+        int64_t now_us = esp_timer_get_time();
+        int64_t cost_us = now_us - frame_start_us;
+        avg_cost_us = (avg_cost_us * 7 + cost_us) / 8;
+
+        // lower the frame rate under load, recover with hysteresis
+        if (avg_cost_us > frame_period_us && frame_divisor_ < MAX_FRAME_DIVISOR) {
+            frame_divisor_++;
+        } else if (frame_divisor_ > 1 && avg_cost_us < panel_period_us * (frame_divisor_ - 1) * 3 / 4) {
+            frame_divisor_--;
+        }
+
+        updateStatistics((uint32_t) (cost_us / 1000));
+
+        // drift-free schedule, sub-tick remainders carry over to the next frame
+        next_frame_us += panel_period_us * frame_divisor_;
+        if (next_frame_us < now_us) {
+            next_frame_us = now_us;     // late, do not burst to catch up
+        }
+
+        vTaskDelay((TickType_t) ((next_frame_us - now_us) / tick_us));  // zero ticks just yields
     }
+}
 
-    running_ = false;
+void Application::updateStatistics(uint32_t elapsed_time_ms) {
+
+    static const uint32_t statistics_cycle_time_ms = 5000;
+
+    statistics_frame_counter_++;
+    statistics_value_counter_ += elapsed_time_ms;
+
+    uint32_t now = getMillis();
+    if (now - statistics_time_ms_ < statistics_cycle_time_ms) return;
+
+    avg_cycle_time_ms_ = statistics_value_counter_ / statistics_frame_counter_;
+    avg_updates_per_sec_ = (statistics_frame_counter_ * 1000) / (now - statistics_time_ms_);
+    overlay_pending_ = true;
+
+    ESP_LOGI(TAG, "avg. cycle time usage: %d/%d ms, updates/sec: %d",
+             avg_cycle_time_ms_,
+             getPeriod(),
+             avg_updates_per_sec_);
+
+    for (int stage = 0; stage < Profiler::NUM_STAGES; stage++) {
+        auto s = profiler_.stats((Profiler::Stage) stage);
+        ESP_LOGI(TAG, "%-8s min/avg/p95/p99/max: %d/%d/%d/%d/%d us",
+                 Profiler::stageName((Profiler::Stage) stage),
+                 (int) s.min_us, (int) s.avg_us, (int) s.p95_us, (int) s.p99_us, (int) s.max_us);
+    }
+
+    ESP_LOGI(TAG, "missed deadlines: %d (last %d frames: %d)",
+             (int) profiler_.missedDeadlines(),
+             (int) profiler_.numFrames(),
+             (int) profiler_.missedDeadlinesInHistory());
+
+    if (PACING_ADAPTIVE == pacing_) {
+        ESP_LOGI(TAG, "pacing: frame divisor %d, skipped renders: %d, skipped refreshes: %d, dropped steps: %d",
+                 frame_divisor_, (int) skipped_renders_, (int) skipped_refreshes_, (int) dropped_steps_);
+    }
+
+    statistics_time_ms_ = now;
+    statistics_frame_counter_ = 0;
+    statistics_value_counter_ = 0;
+}
+
+void Application::setPacing(PacingMode pacing) {
+    pacing_ = pacing;
+}
+
+Application::PacingMode Application::getPacing() const {
+    return pacing_;
+}
+
+float Application::getInterpolation() const {
+    return interpolation_;
 }
 
 void Application::showStatistics(bool show) {
     show_stats_ = show;
+    overlay_pending_ = true;
+    overlay_valid_ = false;
 }
 
-void Application::renderOverlay() {
+bool Application::isShowingStatistics() const {
+    return show_stats_;
+}
 
-    static char buf[32];
+const Profiler& Application::getProfiler() const {
+    return profiler_;
+}
 
-    if (!show_stats_) return;
+// ############################################################################
+// Statistics overlay
+// ############################################################################
 
-    auto display = getDisplay();
+// 3x5 glyphs '0'..'9' and '/', one byte per column (bit 0 = top row)
+static const uint8_t OVERLAY_GLYPHS[11][3] = {
+    {0x1f, 0x11, 0x1f}, {0x12, 0x1f, 0x10}, {0x1d, 0x15, 0x17}, {0x11, 0x15, 0x1f},
+    {0x07, 0x04, 0x1f}, {0x17, 0x15, 0x1d}, {0x1f, 0x15, 0x1d}, {0x01, 0x01, 0x1f},
+    {0x1f, 0x15, 0x1f}, {0x17, 0x15, 0x1f}, {0x18, 0x04, 0x03}
+};
 
-    auto old_font = display->font();
+static const int OVERLAY_GLYPH_SLASH = 10;
+static const int OVERLAY_GLYPH_SHIFT = 2;       // vertical position within the page
 
-    display->setBuiltinFont(0);
+static int overlayGlyph(uint8_t* page, int x, int width, int glyph) {
+    for (int i = 0; i < 3 && x < width; i++) {
+        page[x++] = (uint8_t) (OVERLAY_GLYPHS[glyph][i] << OVERLAY_GLYPH_SHIFT);
+    }
+    return x + 1;
+}
+
+static void overlayText(uint8_t* page, int width, const char* text, size_t length) {
+    int x = 0;
+    for (size_t i = 0; i < length; i++) {
+        char c = text[i];
+        if (c >= '0' && c <= '9') {
+            x = overlayGlyph(page, x, width, c - '0');
+        } else if ('/' == c) {
+            x = overlayGlyph(page, x, width, OVERLAY_GLYPH_SLASH);
+        } else {
+            x += 4;
+        }
+    }
+}
+
+void Application::formatOverlay(graphics::Formatter& text) {
+    text.appendUnsigned(avg_cycle_time_ms_).append('/')
+        .appendUnsigned(getPeriod()).append('/')
+        .appendUnsigned(avg_updates_per_sec_);
+}
 
-    sprintf(buf, "%d/%d/%d", avg_cycle_time_ms_, getPeriod(), avg_updates_per_sec_);
-    display->drawString(0, display->height() - display->font()->height, buf);
+bool Application::updateOverlayText() {
+    graphics::TextBuffer<MAX_OVERLAY_TEXT> text;
+    formatOverlay(text);
 
-    if (!display_->getDeferredUpdate()) {
-        display_->refresh();
+    if (overlay_valid_ && 0 == strcmp(text.c_str(), overlay_text_)) {
+        return false;
     }
 
-   display->setFont(old_font);
+    memcpy(overlay_text_, text.c_str(), text.length() + 1);
+    return true;
+}
+
+void Application::renderOverlayPage(int width) {
+    memset(overlay_, 0, sizeof(overlay_));
+    overlayText(overlay_, width, overlay_text_, strlen(overlay_text_));
+}
+void Application::releaseOverlay() {
+    if (overlay_page_ < 0) return;
+
+    // hand the page back, its content is restored with the next frame
+    auto device = display_->device();
+    device->lockPage(overlay_page_, false);
+    device->markRegion(0, device->width() - 1, overlay_page_ * 8);
+    overlay_page_ = -1;
+}
+
+void Application::renderOverlay() {
+
+    if (!show_stats_) {
+        releaseOverlay();
+        return;
+    }
+
+    auto device = display_->device();
+    int width = device->width();
+    if (width > MAX_OVERLAY_WIDTH) width = MAX_OVERLAY_WIDTH;
+
+    // reserve the bottom page, regular refreshes skip it
+    int page = device->height() / 8 - 1;
+    if (page != overlay_page_) {
+        releaseOverlay();
+        device->lockPage(page, true);
+        overlay_page_ = page;
+        overlay_pending_ = true;
+        overlay_valid_ = false;
+    }
+
+    // format once per statistics interval, render only if the text differs
+    bool changed = false;
+    if (overlay_pending_) {
+        overlay_pending_ = false;
+        changed = updateOverlayText();
+        if (changed) renderOverlayPage(width);
+    }
+
+    // keep the buffer in sync for full refreshes, which ignore page locks
+    memcpy(device->buffer() + page * device->width(), overlay_, width);
+
+    if (changed) {
+        device->markRegion(0, width - 1, page * 8);
+        device->refreshPage(page, true);
+        overlay_valid_ = true;
+    }
 }
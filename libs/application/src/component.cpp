@@ -0,0 +1,90 @@
+//
+// Component
+//
+#include "application/component.h"
+
+#include "graphics/graphics.h"
+
+using namespace application;
+
+Component::Component() {}
+
+void Component::init() {}
+
+void Component::update() {}
+
+void Component::render() {}
+
+void Component::setPeriod(uint32_t period_ms) {
+    period_ms_ = (period_ms > 0) ? period_ms : 1;
+}
+
+uint32_t Component::getPeriod() const {
+    return period_ms_;
+}
+
+void Component::setRegion(int x, int y, int x2, int y2) {
+    region_.set(x, x2, y, y2);
+    region_.normalize();
+    invalid_ = true;
+}
+
+const graphics::Rectangle& Component::getRegion() const {
+    return region_;
+}
+
+void Component::setLayer(int layer) {
+    layer_ = layer;
+}
+
+int Component::getLayer() const {
+    return layer_;
+}
+
+void Component::setOpaque(bool opaque) {
+    opaque_ = opaque;
+}
+
+bool Component::isOpaque() const {
+    return opaque_;
+}
+
+void Component::setPartialRender(bool enable) {
+    partial_render_ = enable;
+}
+
+bool Component::isPartialRender() const {
+    return partial_render_;
+}
+
+void Component::invalidate() {
+    invalid_ = true;
+}
+
+bool Component::isInvalid() const {
+    return invalid_;
+}
+
+void Component::setAutoInvalidate(bool enable) {
+    auto_invalidate_ = enable;
+}
+
+bool Component::isAutoInvalidate() const {
+    return auto_invalidate_;
+}
+
+graphics::Display* Component::getDisplay() {
+    return display_;
+}
+
+uint32_t Component::getUpdateCounter() const {
+    return update_counter_;
+}
+
+uint32_t Component::getDeltaMillis() const {
+    return delta_time_ms_;
+}
+
+float Component::getDelta() const {
+    return (float) delta_time_ms_ / 1000.0f;
+}
@@ -0,0 +1,119 @@
+//
+// Profiler
+//
+#include "application/profiler.h"
+
+#include "esp_timer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace application;
+
+Profiler::Profiler() {
+    reset();
+}
+
+int64_t Profiler::now() {
+    return esp_timer_get_time();
+}
+
+void Profiler::reset() {
+    memset(samples_, 0, sizeof(samples_));
+    memset(missed_, 0, sizeof(missed_));
+    memset(current_, 0, sizeof(current_));
+    head_ = 0;
+    count_ = 0;
+    missed_deadlines_ = 0;
+}
+
+void Profiler::setDeadline(uint32_t deadline_us) {
+    deadline_us_ = deadline_us;
+}
+
+void Profiler::beginFrame() {
+    frame_start_ = stage_start_ = now();
+    memset(current_, 0, sizeof(current_));
+}
+
+void Profiler::endStage(Stage stage) {
+    int64_t t = now();
+    current_[stage] += (uint32_t) (t - stage_start_);
+    stage_start_ = t;
+}
+
+void Profiler::endFrame() {
+    current_[STAGE_FRAME] = (uint32_t) (now() - frame_start_);
+
+    bool missed = (deadline_us_ > 0 && current_[STAGE_FRAME] > deadline_us_);
+    if (missed) missed_deadlines_++;
+
+    memcpy(samples_[head_], current_, sizeof(current_));
+    missed_[head_] = missed;
+
+    head_ = (head_ + 1) % HISTORY_SIZE;
+    if (count_ < HISTORY_SIZE) count_++;
+}
+
+size_t Profiler::numFrames() const {
+    return count_;
+}
+
+uint32_t Profiler::sample(Stage stage, size_t age) const {
+    if (age >= count_) return 0;
+    size_t index = (head_ + HISTORY_SIZE - 1 - age) % HISTORY_SIZE;
+    return samples_[index][stage];
+}
+
+Profiler::StageStats Profiler::stats(Stage stage) const {
+    StageStats s;
+    if (0 == count_) return s;
+
+    uint64_t sum = 0;
+    s.min_us = UINT32_MAX;
+
+    for (size_t i = 0; i < count_; i++) {
+        uint32_t value = samples_[i][stage];
+        scratch_[i] = value;
+        sum += value;
+        if (value < s.min_us) s.min_us = value;
+        if (value > s.max_us) s.max_us = value;
+    }
+
+    s.avg_us = (uint32_t) (sum / count_);
+
+    // nearest-rank percentiles, partial selection is enough
+    size_t p95 = (count_ * 95 + 99) / 100 - 1;
+    size_t p99 = (count_ * 99 + 99) / 100 - 1;
+
+    std::nth_element(scratch_, scratch_ + p95, scratch_ + count_);
+    s.p95_us = scratch_[p95];
+
+    std::nth_element(scratch_ + p95, scratch_ + p99, scratch_ + count_);
+    s.p99_us = scratch_[p99];
+
+    return s;
+}
+
+uint32_t Profiler::missedDeadlines() const {
+    return missed_deadlines_;
+}
+
+uint32_t Profiler::missedDeadlinesInHistory() const {
+    uint32_t missed = 0;
+    for (size_t i = 0; i < count_; i++) {
+        if (missed_[i]) missed++;
+    }
+    return missed;
+}
+
+const char* Profiler::stageName(Stage stage) {
+    switch (stage) {
+        case STAGE_UPDATE: return "update";
+        case STAGE_RENDER: return "render";
+        case STAGE_OVERLAY: return "overlay";
+        case STAGE_REFRESH: return "refresh";
+        case STAGE_FRAME: return "frame";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,129 @@
+//
+// Scheduler
+//
+#include "application/scheduler.h"
+
+#include "esp_timer.h"
+#include "graphics/graphics.h"
+#include "sys/trace.h"
+
+#define TAG "scheduler"
+
+using namespace application;
+
+Scheduler::Scheduler() : Application() {}
+
+bool Scheduler::addComponent(Component* component) {
+    if (nullptr == component) {
+        return false;
+    }
+
+    if (num_components_ >= MAX_COMPONENTS) {
+        ESP_LOGE(TAG, "too many components (max. %d)", (int) MAX_COMPONENTS);
+        return false;
+    }
+
+    component->display_ = getDisplay();
+    component->next_update_us_ = esp_timer_get_time();
+    component->last_update_us_ = component->next_update_us_ - (int64_t) component->period_ms_ * 1000;
+    component->invalid_ = true;
+    component->init();
+
+    // insert sorted by layer, keep insertion order within a layer
+    size_t pos = num_components_;
+    while (pos > 0 && components_[pos - 1]->layer_ > component->layer_) {
+        components_[pos] = components_[pos - 1];
+        pos--;
+    }
+
+    components_[pos] = component;
+    num_components_++;
+
+    return true;
+}
+
+size_t Scheduler::numComponents() const {
+    return num_components_;
+}
+
+Component* Scheduler::getComponent(size_t index) {
+    return (index < num_components_) ? components_[index] : nullptr;
+}
+
+void Scheduler::update() {
+    TRACE_SCOPE("scheduler.update");
+
+    int64_t now = esp_timer_get_time();
+
+    for (size_t i = 0; i < num_components_; i++) {
+        auto component = components_[i];
+        if (now < component->next_update_us_) {
+            continue;
+        }
+
+        component->delta_time_ms_ = (uint32_t) ((now - component->last_update_us_) / 1000);
+        component->last_update_us_ = now;
+
+        component->update();
+        component->update_counter_++;
+        if (component->auto_invalidate_) component->invalid_ = true;
+
+        // keep the schedule, but do not catch up on missed periods
+        component->next_update_us_ += (int64_t) component->period_ms_ * 1000;
+        if (component->next_update_us_ <= now) {
+            component->next_update_us_ = now + (int64_t) component->period_ms_ * 1000;
+        }
+    }
+}
+
+void Scheduler::render() {
+    TRACE_SCOPE("scheduler.render");
+
+    auto display = getDisplay();
+
+    // a transparent component needs the components below to be redrawn first
+    for (size_t i = num_components_; i > 0; i--) {
+        auto component = components_[i - 1];
+        if (!component->invalid_ || component->opaque_ || component->partial_render_) continue;
+
+        for (size_t j = 0; j < i - 1; j++) {
+            if (components_[j]->region_.intersects(component->region_)) {
+                components_[j]->invalid_ = true;
+            }
+        }
+    }
+
+    bool dirty = false;
+
+    for (size_t i = 0; i < num_components_; i++) {
+        auto component = components_[i];
+        if (!component->invalid_) continue;
+
+        const auto& region = component->region_;
+
+        if (component->opaque_ && !component->partial_render_) {
+            auto old_foreground = display->setForeground(graphics::BLACK);
+            display->fillRectangle(region.left, region.top, region.right, region.bottom);
+            display->setForeground(old_foreground);
+        }
+
+        component->render();
+        component->invalid_ = false;
+
+        if (!component->partial_render_) {
+            display->device()->markRegion(region);
+        }
+        dirty = true;
+
+        // overlapping components on top have been painted over
+        for (size_t j = i + 1; j < num_components_; j++) {
+            if (components_[j]->region_.intersects(region)) {
+                components_[j]->invalid_ = true;
+            }
+        }
+    }
+
+    if (dirty) {
+        display->update();  // one refresh of the merged dirty regions
+    }
+}
@@ -106,6 +106,10 @@ class Rectangle {
         return (top <= bottom) && (left <= right);
     }
 
+    bool intersects(const Rectangle& r) const {
+        return (left <= r.right) && (r.left <= right) && (top <= r.bottom) && (r.top <= bottom);
+    }
+
     void normalize();
 
    public:
@@ -141,4 +145,15 @@ template <typename T> void sort_pair(T& a, T& b) {
     }
 }
 
+//! @brief Integer division rounding towards negative infinity (b > 0)
+inline int floorDiv(int a, int b) {
+    return (a >= 0) ? a / b : -((-a + b - 1) / b);
+}
+
+//! @brief Integer modulo with the sign of the divisor (b > 0)
+inline int floorMod(int a, int b) {
+    int m = a % b;
+    return (m < 0) ? m + b : m;
+}
+
 }  // namespace
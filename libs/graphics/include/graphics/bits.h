@@ -52,4 +52,9 @@ enum class PanelType : uint8_t {
     SSD1306_128x32 = 2   //!< 128x64 panel
 };
 
+enum class RefreshMode : uint8_t {
+    Immediate = 0,          //!< transfer dirty pages right away
+    ScanSynchronized = 1    //!< transfer each page just behind the row scan
+};
+
 } // namespace graphics
@@ -0,0 +1,132 @@
+//
+// Console
+//
+#pragma once
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+
+#include "freertos/FreeRTOS.h"
+
+#include "graphics/base.h"
+#include "graphics/scroller.h"
+
+namespace graphics {
+
+class Device;
+
+/**
+ * Text console. Keeps a ring of text lines in character cells of one page
+ * height and renders only the characters appended or overwritten since the
+ * last draw(), so each new character costs one cell of display transfer.
+ *
+ * New lines scroll either with the display start line (whole panel, one page
+ * per line) or by shifting the pages of a viewport.
+ *
+ * Text can be written from any task, attachLog() mirrors the ESP_LOGx output.
+ */
+class Console : public VerticalScroller {
+    public:
+        static const int MAX_COLUMNS = 32;
+        static const int MAX_LINES = 16;    // text history, at least one panel
+
+    public:
+        Console();
+        ~Console();
+
+    public:
+        /**
+         * @brief   Set font, characters must fit into a page (height <= 8)
+         * @return  true on success
+         */
+        bool setFont(const Font* font);
+
+        /**
+         * @brief   Set pages used by the console (page shifting only),
+         *          pages outside of the panel are not used
+         */
+        void setViewport(int first_page, int last_page);
+
+        /**
+         * @brief   Scroll with the display start line, the console covers the whole panel
+         */
+        void setHardwareScroll(bool enable);
+        bool isHardwareScroll() const;
+
+        int columns() const;
+
+    public:
+        /**
+         * @brief   Clear all text
+         */
+        void clear();
+
+        /**
+         * @brief   Write text. Handles '\n', '\r' and '\b', skips ANSI escape sequences.
+         */
+        void write(const char* str, size_t len);
+        void print(const char* str);
+        int printf(const char* format, ...);
+        int vprintf(const char* format, va_list args);
+
+        /**
+         * @brief   Render changed characters into the framebuffer and mark them for refresh
+         * @param   device  Target device
+         */
+        void draw(Device* device);
+
+    public:
+        /**
+         * @brief   Mirror log output to a console, nullptr detaches
+         */
+        static void attachLog(Console* console);
+
+    protected:
+        void renderPage(uint8_t* dest, int width, int index) override;
+
+    private:
+        struct Line {
+            char text[MAX_COLUMNS];
+            uint8_t length;
+            int8_t dirty_first;         // changed columns, none if first > last
+            int8_t dirty_last;
+        };
+
+        Line& line(int number);
+        bool isStored(int number) const;
+        void resetLine(int number);
+        void writeText(const char* str, size_t len);
+        void put(char c);
+        void newLine();
+        void renderCells(uint8_t* dest, const Line& line, int first, int last) const;
+
+        static int logVprintf(const char* format, va_list args);
+
+    private:
+        const Font* font_{nullptr};
+        int cell_width_{6};
+        int columns_{0};
+
+        Line lines_[MAX_LINES];
+        int current_{0};                // line holding the cursor
+        int column_{0};                 // cursor column
+        bool pending_newline_{false};   // line break deferred until the next character
+        bool escape_{false};            // inside ANSI escape sequence
+
+        bool hardware_scroll_{false};
+        int first_page_{0};
+        int last_page_{7};
+        int top_{0};                    // first line in the framebuffer (page shifting)
+        bool valid_{false};
+
+        SemaphoreHandle_t mutex_{nullptr};
+
+    public:
+        Console(const Console&) = delete;
+        Console(const Console&&) = delete;
+        Console& operator=(const Console&) = delete;
+        Console& operator=(const Console&&) = delete;
+};
+
+}  // namespace graphics
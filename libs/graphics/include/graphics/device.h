@@ -193,6 +193,44 @@ class Device {
         */
         void setVerticalOffset(int ofs);
 
+        /*!
+            @brief  Set refresh mode.
+            @param  mode
+                    RefreshMode::Immediate transfers dirty pages right away.
+                    RefreshMode::ScanSynchronized visits pages in scan order, starting
+                    with the page the row scan has just left, and starts each transfer
+                    only when it completes before the scan's next pass over the page,
+                    so the panel never shows a page that is half old and half new.
+                    A single update may still span two panel frames. Waits of whole
+                    ticks block, shorter ones busy wait. Exact for start lines on
+                    page boundaries.
+            @return None (void).
+        */
+        void setRefreshMode(RefreshMode mode);
+
+        /*!
+            @brief  Get refresh mode.
+            @return Current refresh mode
+        */
+        RefreshMode refreshMode() const;
+
+        /*!
+            @brief  Set scan phase calibration point.
+            @param  frame_start_us
+                    esp_timer time at which the panel started scanning row 0,
+                    e.g. taken from the FR pin. Set to the display-on time by init().
+            @return None (void).
+        */
+        void calibrateScan(int64_t frame_start_us);
+
+        /*!
+            @brief  Estimate the row currently scanned by the panel.
+            @param  time_us
+                    esp_timer time
+            @return Scan position (0 = top row of the panel), or -1 if unknown
+        */
+        int scanPosition(int64_t time_us) const;
+
     private:
         /*!
             @brief  Send command to SSD1306.
@@ -230,6 +268,14 @@ class Device {
         */
         void setPageRegion(int x_start, int x_end, int page);
 
+        /*!
+            @brief  Transfer pages in scan order, each just behind the row scan.
+            @param  force
+                    Transfer all pages, ignoring dirty regions and locks
+            @return None (void).
+        */
+        void refreshScanSynchronized(bool force);
+
     public:
         /*!
             @brief  Mark dirty region
@@ -310,6 +356,11 @@ class Device {
         uint8_t num_pages_;             // number of pages (4 or 8)
         bool partial_updates_enabled_;  // enable dirty regions handling
         float frequency_;               // display frequency
+        RefreshMode refresh_mode_;      // refresh mode
+        uint8_t start_line_;            // display start line (vertical offset)
+        int64_t scan_epoch_us_;         // calibration point (start of a scan frame)
+        int64_t scan_period_us_;        // scan frame period
+        int64_t page_transfer_us_;      // estimated transfer time of a full page
         Page page_info_[8];             // page_info
 
     public:
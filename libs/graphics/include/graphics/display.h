@@ -9,9 +9,12 @@
 
 #include "graphics/base.h"
 #include "graphics/device.h"
+#include "graphics/sprite.h"
 
 namespace graphics {
 
+class Layer;
+
 class Display {
     public: // Generic methods
         /**
@@ -45,6 +48,26 @@ class Display {
          */
         int height();
 
+        /**
+         * @brief   Set drawing target
+         * @param   layer   Layer to draw into, or nullptr to draw to the device
+         * @return  Previous drawing target
+         * @remark  width() and height() return the size of the target
+         */
+        Layer* setLayer(Layer* layer);
+
+        /**
+         * @brief   Get drawing target
+         * @return  Current layer, or nullptr when drawing to the device
+         */
+        Layer* layer() const;
+
+        /**
+         * @brief   Get sprite manager
+         * @return  Sprites drawn into the device framebuffer
+         */
+        SpriteManager& sprites();
+
     public: // Colors
 
         /**
@@ -75,6 +98,18 @@ class Display {
 
     private: // Low-level drawing
 
+        /*!
+            @brief  Get buffer of the drawing target
+            @return Pointer to layer or device buffer
+        */
+        inline uint8_t* targetBuffer();
+
+        /*!
+            @brief  Mark dirty region of the drawing target
+        */
+        template <typename... Args>
+        inline void markDirty(Args... args);
+
         /*!
             @brief  Get mask of pixel
             @return Pixel bit mask
@@ -241,6 +276,29 @@ class Display {
          */
         int drawString(int x, int y, const char* str);
 
+        /**
+         * @brief   Draw string of given length using currently selected font,
+         *          the string does not need to be null-terminated
+         * @param   x           X position of string (top-left corner)
+         * @param   y           Y position of string (top-left corner)
+         * @param   str         Characters to draw
+         * @param   length      Number of characters
+         * @return  Width of the string (out-of-display pixels also included)
+         */
+        int drawString(int x, int y, const char* str, size_t length);
+
+        /**
+         * @brief   Draw decimal number using currently selected font, without
+         *          intermediate string allocation
+         * @param   x           X position of number (top-left corner)
+         * @param   y           Y position of number (top-left corner)
+         * @param   value       The number to draw
+         * @param   width       Minimum number of characters
+         * @param   pad         Padding character
+         * @return  Width of the number (out-of-display pixels also included)
+         */
+        int drawString(int x, int y, int value, int width = 0, char pad = ' ');
+
         /**
          * @brief   Measure width of string with current selected font
          * @param   str         String to measure
@@ -255,6 +313,14 @@ class Display {
          */
         int measureString(const char* str);
 
+        /**
+         * @brief   Measure width of string of given length with current selected font
+         * @param   str         Characters to measure
+         * @param   length      Number of characters
+         * @return  Width of the string
+         */
+        int measureString(const char* str, size_t length);
+
         /**
          * @brief   Get descriptor of char
          * @param   c         Character to get descriptor
@@ -475,6 +541,8 @@ class Display {
         uint8_t width_{0};                                    // panel width (128)
         uint8_t height_{0};                                   // panel height (32 or 64)
         const Font* font_{nullptr};                           // current font
+        Layer* layer_{nullptr};                               // drawing target (nullptr: device)
+        SpriteManager sprites_{this};                         // software sprites
         update_state_t update_state_{NO_UPDATE_NEEDED};       // update state
         bool deferred_update_{false};                         // deferred update
         Color foreground_{WHITE};                             // foreground color
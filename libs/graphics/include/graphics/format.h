@@ -0,0 +1,103 @@
+//
+// Text Formatting
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graphics {
+
+/**
+ * Allocation-free text formatting into a caller provided buffer. Numbers are
+ * converted to digits directly, without printf and locale handling, which is
+ * cheap enough to run on every frame. Output that does not fit is truncated,
+ * the buffer always stays null-terminated.
+ */
+class Formatter {
+    public:
+        /**
+         * @brief   Create formatter
+         * @param   buffer  Output buffer
+         * @param   size    Size of the buffer in bytes (including terminator)
+         */
+        Formatter(char* buffer, size_t size);
+
+    public:
+        /**
+         * @brief   Append string
+         */
+        Formatter& append(const char* str);
+
+        /**
+         * @brief   Append string of given length
+         */
+        Formatter& append(const char* str, size_t length);
+
+        /**
+         * @brief   Append character
+         */
+        Formatter& append(char c);
+
+        /**
+         * @brief   Append signed integer
+         * @param   value   Value
+         * @param   width   Minimum number of characters
+         * @param   pad     Padding character, '0' pads between sign and digits
+         */
+        Formatter& appendInt(int32_t value, int width = 0, char pad = ' ');
+
+        /**
+         * @brief   Append unsigned integer
+         * @param   value   Value
+         * @param   width   Minimum number of characters
+         * @param   pad     Padding character
+         */
+        Formatter& appendUnsigned(uint32_t value, int width = 0, char pad = ' ');
+
+        /**
+         * @brief   Append fixed-point number, rounded to the given decimals
+         * @param   value       Value in fixed-point format
+         * @param   frac_bits   Number of fraction bits of the value
+         * @param   decimals    Number of decimal places (0..6)
+         * @param   width       Minimum number of characters
+         * @param   pad         Padding character
+         */
+        Formatter& appendFixed(int32_t value, int frac_bits, int decimals, int width = 0, char pad = ' ');
+
+        /**
+         * @brief   Discard the text
+         */
+        Formatter& clear();
+
+        const char* c_str() const;
+        size_t length() const;
+
+    private:
+        Formatter& appendNumber(bool negative, uint32_t integer, uint32_t fraction, int decimals, int width, char pad);
+
+    private:
+        char* buffer_;
+        size_t size_;
+        size_t length_{0};
+};
+
+/**
+ * Formatter with its own fixed capacity buffer, meant to live on the stack.
+ */
+template <size_t N>
+class TextBuffer : public Formatter {
+    public:
+        TextBuffer() : Formatter(data_, N) {}
+
+    private:
+        char data_[N];
+
+    public:
+        TextBuffer(const TextBuffer&) = delete;
+        TextBuffer(const TextBuffer&&) = delete;
+        TextBuffer& operator=(const TextBuffer&) = delete;
+        TextBuffer& operator=(const TextBuffer&&) = delete;
+};
+
+}  // namespace graphics
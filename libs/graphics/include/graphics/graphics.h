@@ -4,3 +4,10 @@
 #include "graphics/bitmap.h"
 #include "graphics/device.h"
 #include "graphics/display.h"
+#include "graphics/layer.h"
+#include "graphics/sprite.h"
+#include "graphics/tilemap.h"
+#include "graphics/scroller.h"
+#include "graphics/console.h"
+#include "graphics/spectrum.h"
+#include "graphics/format.h"
@@ -0,0 +1,174 @@
+//
+// Layer
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graphics/base.h"
+
+namespace graphics {
+
+class Compositor;
+class Device;
+
+//! @brief Layer blend mode
+enum class BlendMode : uint8_t {
+    Opaque = 0,     //!< replace pixels below (restricted to the mask, if set)
+    Or = 1,         //!< set pixels
+    And = 2,        //!< clear pixels that are off in the layer
+    Xor = 3         //!< invert pixels
+};
+
+/**
+ * Offscreen buffer in the native page format of the panel (8 vertical pixels
+ * per byte). Layers are positioned on screen and merged by a Compositor.
+ * Draw into a layer with Display::setLayer().
+ */
+class Layer {
+    public:
+        /**
+         * @brief   Constructor
+         * @param   width   Layer width
+         * @param   height  Layer height
+         */
+        Layer(int width, int height);
+
+    public:
+        int width() const;
+        int height() const;
+
+        uint8_t* buffer();
+        const uint8_t* buffer() const;
+        size_t bufferSize() const;
+
+        /**
+         * @brief   Clear layer buffer (all pixels off) and mark it dirty
+         */
+        void clear();
+
+    public:
+        /**
+         * @brief   Set screen position, marks old and new area dirty
+         * @param   x   Horizontal position (may be partially off-screen)
+         * @param   y   Vertical position (need not be page aligned)
+         */
+        void setPosition(int x, int y);
+        int x() const;
+        int y() const;
+
+        void setVisible(bool visible);
+        bool isVisible() const;
+
+        void setBlendMode(BlendMode mode);
+        BlendMode blendMode() const;
+
+        /**
+         * @brief   Set coverage mask, a layer of the same size with pixels
+         *          on where this layer is opaque. Used by BlendMode::Opaque.
+         * @param   mask    Mask layer or nullptr to cover the whole layer
+         */
+        void setMask(const Layer* mask);
+        const Layer* mask() const;
+
+    public: // Dirty region tracking (layer coordinates)
+        void markRegion(int x, int y);
+        void markRegion(int x_start, int x_end, int y);
+        void markRegion(int x_start, int x_end, int y_start, int y_end);
+        void markRegion(const Rectangle& region);
+        void markAll();
+
+        /**
+         * @brief   Get dirty region in screen coordinates
+         * @return  Dirty region, valid if isDirty() is true
+         */
+        const Rectangle& dirtyRegion() const;
+        bool isDirty() const;
+        void clearDirty();
+
+    private:
+        void markScreenRegion(int x_start, int x_end, int y_start, int y_end);
+        uint8_t fetch(int x, int y) const;
+
+    private:
+        friend class Compositor;
+
+        int width_;
+        int height_;
+        int num_pages_;
+        std::vector<uint8_t> buffer_;           // page format, num_pages_ * width_
+        int x_{0};                              // screen position
+        int y_{0};
+        bool visible_{true};
+        BlendMode blend_mode_{BlendMode::Opaque};
+        const Layer* mask_{nullptr};
+        Rectangle dirty_region_;                // screen coordinates
+        bool dirty_{false};
+
+    public:
+        Layer(const Layer&) = delete;
+        Layer(const Layer&&) = delete;
+        Layer& operator=(const Layer&) = delete;
+        Layer& operator=(const Layer&&) = delete;
+        ~Layer() = default;
+};
+
+/**
+ * Merges layers into the device framebuffer. Only pages intersecting
+ * a dirty layer region are recomposited, and only the dirty columns
+ * of those pages are marked for the next refresh.
+ */
+class Compositor {
+    public:
+        static const size_t MAX_LAYERS = 8;
+
+    public:
+        Compositor();
+
+    public:
+        /**
+         * @brief   Add layer on top of the current layers
+         * @return  true if successful
+         */
+        bool addLayer(Layer* layer);
+
+        /**
+         * @brief   Remove layer
+         * @return  true if the layer was found
+         */
+        bool removeLayer(Layer* layer);
+
+        size_t numLayers() const;
+
+        /**
+         * @brief   Recomposite the whole screen with the next compose()
+         */
+        void invalidate();
+
+        /**
+         * @brief   Merge dirty layer regions into the device framebuffer
+         * @param   device  Target device
+         * @return  true if any page was recomposited
+         */
+        bool compose(Device* device);
+
+    private:
+        void composePage(Device* device, int page, int x_start, int x_end);
+
+    private:
+        Layer* layers_[MAX_LAYERS];             // bottom to top
+        size_t num_layers_{0};
+        bool invalid_{true};
+        std::vector<uint8_t> line_;             // composited page span
+
+    public:
+        Compositor(const Compositor&) = delete;
+        Compositor(const Compositor&&) = delete;
+        Compositor& operator=(const Compositor&) = delete;
+        Compositor& operator=(const Compositor&&) = delete;
+        ~Compositor() = default;
+};
+
+}  // namespace graphics
@@ -3,20 +3,232 @@
 //
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 #include "driver/adc.h"
+#include "graphics/spectrum.h"
+#include "sys/samplebuffer.h"
 
 namespace graphics {
 
 class Display;
 
+/**
+ * Trace rendering
+ */
+enum class TraceMode {
+    Line,           // connect one value per column
+    PeakDetect      // vertical span from minimum to maximum of each column
+};
+
+/**
+ * Displayed view
+ */
+enum class ScopeView {
+    Time,
+    Spectrum
+};
+
+/**
+ * Trigger slope, None runs the display freely (roll mode)
+ */
+enum class TriggerEdge {
+    None,
+    Rising,
+    Falling
+};
+
+/**
+ * Trace pattern, keeps overlaid channels distinguishable on a 1-bit display
+ */
+enum class TraceStyle {
+    Solid,
+    Dotted,         // every other pixel (checkerboard)
+    Xor             // inverts the pixels below
+};
+
+/**
+ * Roll mode rendering (no trigger)
+ */
+enum class RollMode {
+    Scroll,         // newest column at the right edge, the whole trace moves
+    Sweep           // write position wraps around, only new columns are drawn
+};
+
 class Oscilloscope {
    public:
-    void init();
+    static const size_t MAX_CHANNELS = 4;
+    static const size_t DEFAULT_COLUMNS = 128;
+
+   public:
+    /**
+     * @brief   Initialize. Roll mode columns, captures, pre-trigger history and
+     *          spectrum input are heap vectors of int values, sized by columns
+     *          and channels. Only the deep memory has a selectable sample
+     *          format and memory source, see setDeepMemory().
+     * @param   columns     Columns kept for roll mode and captures
+     */
+    void init(size_t columns = DEFAULT_COLUMNS);
+
+    /**
+     * @brief   Add a sample to channel 0, other channels repeat their last value.
+     *          Any int is accepted, deep memory stores it clamped to 0..4095.
+     */
     void add(int value);
+
+    /**
+     * @brief   Add samples, interleaved frames of one value per channel
+     * @param   values  Samples
+     * @param   count   Number of samples (a multiple of the channel count)
+     */
+    void add(const uint16_t* values, size_t count);
+
     void clear();
-    int getValue() const;
+    int getValue(size_t channel = 0) const;
+
+   public:
+    /**
+     * @brief   Set number of channels (clears the buffers)
+     */
+    void setChannels(size_t count);
+    size_t getChannels() const;
+
+    /**
+     * @brief   Map the samples of a channel to value * gain + offset. All
+     *          channels share one vertical scale, offsets separate the traces.
+     */
+    void setChannelScale(size_t channel, float gain, int offset = 0);
+    void setChannelStyle(size_t channel, TraceStyle style);
+
+    /**
+     * @brief   Set the channel watched by the trigger and the spectrum
+     */
+    void setSourceChannel(size_t channel);
+    size_t getSourceChannel() const;
+
+   public:
+    /**
+     * @brief   Set decimation: number of samples reduced to one column (min/max)
+     */
+    void setSamplesPerColumn(size_t count);
+    size_t getSamplesPerColumn() const;
+
+    void setTraceMode(TraceMode mode);
+    TraceMode getTraceMode() const;
+
+    /**
+     * @brief   Show the envelope of past traces (persistence)
+     * @param   enable  Enable envelope
+     * @param   decay   Pixels the envelope shrinks towards the trace per draw, 0 keeps it
+     */
+    void setEnvelope(bool enable, int decay = 0);
+    void resetEnvelope();
+
+   public:
+    /**
+     * @brief   Set trigger. A capture of one screen starts when the source
+     *          channel crosses the level (scaled value) after having been
+     *          beyond level -/+ hysteresis.
+     * @param   edge        Trigger edge, None for roll mode
+     * @param   level       Trigger level
+     * @param   hysteresis  Distance the signal has to leave the level to re-arm
+     */
+    void setTrigger(TriggerEdge edge, int level, int hysteresis = 0);
+    TriggerEdge getTriggerEdge() const;
+
+    /**
+     * @brief   Set minimum number of samples between two triggers
+     */
+    void setHoldoff(size_t samples);
+
+    /**
+     * @brief   Set number of samples shown before the trigger point, limited
+     *          to the capture length (re-applied by init() and setSamplesPerColumn())
+     */
+    void setPreTrigger(size_t samples);
+
+    /**
+     * @brief   Check for a capture completed since the last call
+     */
+    bool takeNewCapture();
+    uint32_t getTriggerCount() const;
+
+   public:
+    /**
+     * @brief   Set up the deep memory for single-shot captures of many samples
+     *          per channel, shown with zoom and pan. A capacity of 0 disables it.
+     *          Samples are stored as 12 bit values, clamped to 0..4095.
+     * @param   capacity    Frames (samples per channel) at the current channel
+     *                      count, a later setChannels() keeps the memory size
+     * @param   format      Sample storage format
+     * @param   source      Internal or External (PSRAM) memory
+     * @return  true on success
+     */
+    bool setDeepMemory(size_t capacity,
+                       sys::SampleFormat format = sys::SampleFormat::Packed12,
+                       sys::MemorySource source = sys::MemorySource::Internal);
+
+    /**
+     * @brief   Set up the deep memory in a static arena (2 byte aligned)
+     */
+    bool setDeepMemory(void* arena, size_t size, sys::SampleFormat format = sys::SampleFormat::Packed12);
+    bool isDeepMemory() const;
+
+    /**
+     * @brief   Start a deep capture at the next trigger, or right away in roll mode
+     */
+    void arm();
+
+    /**
+     * @brief   Number of frames of the last complete deep capture, 0 if none
+     */
+    size_t getDeepLength() const;
+
+    /**
+     * @brief   Select the shown part of the deep capture. Any zoom level is
+     *          drawn in O(width) from a min/max mipmap.
+     * @param   first               First frame shown
+     * @param   frames_per_column   Zoom
+     */
+    void setDeepView(size_t first, size_t frames_per_column);
+    size_t getDeepPosition() const;
+    size_t getDeepZoom() const;
+
+   public:
+    /**
+     * @brief   Select time or spectrum view. Both use the same samples.
+     */
+    void setView(ScopeView view);
+    ScopeView getView() const;
+    Spectrum& spectrum();
+
+    /**
+     * @brief   Advance the spectrum analysis (spectrum view only)
+     * @return  true when a new spectrum is ready to be drawn
+     */
+    bool process();
+
+   public:
+    /**
+     * @brief   Set roll mode rendering. In sweep mode, draw() renders only the
+     *          columns added since the last call (plus a small erase gap ahead
+     *          of them) and marks just those dirty on the device itself.
+     */
+    void setRollMode(RollMode mode);
+    RollMode getRollMode() const;
+
+    /**
+     * @brief   Check if draw() renders incrementally (sweep mode, no trigger,
+     *          time view). The caller then must neither clear nor mark the area.
+     */
+    bool isIncremental() const;
+
+    /**
+     * @brief   Redraw the whole area with the next incremental draw
+     */
+    void invalidate();
 
    public:
     void draw(graphics::Display* display);
@@ -24,20 +236,133 @@ class Oscilloscope {
               bool show_text, int text_pos_x, int text_pos_y);
 
    private:
-    int fetch_data();
+    struct Column {
+        int min;
+        int max;
+        int last;
+    };
+
+    struct Channel {
+        int32_t gain{256};                  // Q8
+        int offset{0};
+        TraceStyle style{TraceStyle::Solid};
+        int value{0};                       // last raw sample
+    };
+
+    struct Range {
+        uint16_t min;
+        uint16_t max;
+    };
+
+    void scaleFrame(const int* raw, int* frame) const;
+    void addFrame(const int* frame, const int* raw);
+    void pushColumn();
+    void pushHistory(const int* raw);
+
+    void updateTrigger(int value);
+    bool isTriggerEdge(int value) const;
+    void addTriggered(const int* frame, const int* raw);
+    void startCapture(const int* frame);
+    void captureFrame(const int* frame);
+    void completeCapture();
+    size_t captureLength() const;
+    void applyPreTrigger();
+
+    void resetDeep();
+    size_t deepCapacity() const;
+    void addDeep(const int* frame, const int* raw);
+    void startDeep(const int* raw);
+    void recordDeep(const int* raw);
+    void completeDeep();
+    Column deepColumn(size_t first, size_t last, size_t channel) const;
+
+    const Column* screenColumns(int x, int width) const;
+    int toScreen(int value, int y1, int height) const;
+    void drawColumn(graphics::Display* display, int x, int y1, int height,
+                    const Column& column, const Column* previous, TraceStyle style,
+                    int& top, int& bottom) const;
+    void drawSweep(graphics::Display* display, int x1, int y1, int x2, int y2);
+    void drawDeep(graphics::Display* display, int x1, int y1, int x2, int y2);
 
    private:
-    char textbuffer_[128];
-    int value_{0};
+    Channel channels_[MAX_CHANNELS];
+    size_t num_channels_{1};
+    size_t source_channel_{0};
     int min_value_{0};
     int max_value_{0};
     bool first_value_{false};
 
-    std::vector<int> buffer_;
+    // column buffers hold one Column per channel for each position (interleaved),
+    // scaled values that may exceed 12 bits, so they stay unpacked on the heap
+
+    std::vector<Column> buffer_;            // decimated columns
     size_t buffer_size_{0};
     size_t buffer_ofs_{0};
     size_t buffer_usage_{0};
-    size_t buffer_read_ofs_{0};
+    size_t columns_total_{0};               // columns pushed since clear()
+
+    Column bucket_[MAX_CHANNELS]{};         // column being collected
+    size_t bucket_count_{0};
+    size_t samples_per_column_{1};
+    TraceMode trace_mode_{TraceMode::Line};
+
+    TriggerEdge trigger_edge_{TriggerEdge::None};
+    int trigger_level_{0};
+    int trigger_hysteresis_{0};
+    bool trigger_armed_{false};
+    size_t holdoff_{0};
+    size_t pre_trigger_{0};                 // clamped to the capture length
+    size_t pre_trigger_request_{0};         // as set by setPreTrigger()
+    size_t since_trigger_{0};               // samples since the last trigger
+    uint32_t trigger_count_{0};
+
+    std::vector<int> history_;              // last raw frames for the pre-trigger part
+    size_t history_ofs_{0};
+    size_t history_usage_{0};
+
+    std::vector<Column> acquisition_;       // capture being recorded
+    std::vector<Column> capture_;           // last complete capture (displayed)
+    size_t acquisition_columns_{0};
+    size_t capture_columns_{0};
+    Column acquisition_bucket_[MAX_CHANNELS]{};
+    size_t acquisition_bucket_count_{0};
+    size_t capture_remaining_{0};           // post-trigger samples still to record
+    bool capturing_{false};
+    bool new_capture_{false};
+
+    static const size_t MIP_BLOCK = 16;     // frames per entry of the first level
+    static const size_t MIP_FANOUT = 4;     // entries merged into one of the next level
+    static const size_t MAX_MIP_LEVELS = 8;
+
+    sys::SampleBuffer deep_;                // raw frames, channels interleaved
+    std::vector<Range> mipmap_;             // min/max per block, level by level, per channel
+    size_t mip_offsets_[MAX_MIP_LEVELS]{};  // first entry of each level
+    size_t mip_levels_{0};
+    size_t deep_length_{0};                 // frames recorded
+    bool deep_armed_{false};
+    bool deep_recording_{false};
+    bool deep_complete_{false};
+    size_t deep_first_{0};
+    size_t deep_zoom_{1};
+
+    ScopeView view_{ScopeView::Time};
+    Spectrum spectrum_;
+    std::vector<int> samples_;              // newest raw source samples for the spectrum
+    size_t samples_ofs_{0};
+    size_t samples_usage_{0};
+    size_t samples_new_{0};                 // samples since the last transform started
+
+    RollMode roll_mode_{RollMode::Scroll};
+    bool sweep_valid_{false};               // area holds the columns up to sweep_drawn_
+    size_t sweep_drawn_{0};
+    int sweep_min_{0};                      // scaling and area of the drawn columns
+    int sweep_max_{0};
+    int sweep_area_[4]{0, 0, 0, 0};
+
+    bool envelope_{false};
+    int envelope_decay_{0};
+    std::vector<int> envelope_top_;         // screen rows per column and channel, empty if unset
+    std::vector<int> envelope_bottom_;
 };
 
 }  // namespace graphics
@@ -0,0 +1,77 @@
+//
+// Vertical Scroller
+//
+#pragma once
+
+#include <cstdint>
+
+namespace graphics {
+
+class Device;
+
+/**
+ * Hardware assisted vertical scrolling. The display RAM is used as a ring
+ * buffer indexed by content row, the display start line selects the row
+ * shown at the top of the panel. Scrolling moves the start line and only
+ * draws and transfers the page holding the rows that came into view.
+ *
+ * The scroller covers the whole panel. Derive from it and implement
+ * renderPage() to provide the content.
+ */
+class VerticalScroller {
+    public:
+        static const int MAX_WIDTH = 128;
+
+    public:
+        VerticalScroller();
+        virtual ~VerticalScroller() = default;
+
+    public:
+        /**
+         * @brief   Set scroll position (content row shown at the top of the panel)
+         */
+        void setPosition(int y);
+        int position() const;
+
+        /**
+         * @brief   Scroll by number of pixels (positive scrolls content up)
+         */
+        void scroll(int pixels);
+
+        /**
+         * @brief   Redraw the whole panel with the next update()
+         */
+        void invalidate();
+
+        /**
+         * @brief   Draw and transfer exposed content, then move the start line
+         * @param   device  Target device
+         */
+        void update(Device* device);
+
+    protected:
+        /**
+         * @brief   Render a content page
+         * @param   dest    Page buffer (width bytes, page format)
+         * @param   width   Page width in pixels
+         * @param   index   Content page (rows index*8 to index*8+7), may be negative
+         */
+        virtual void renderPage(uint8_t* dest, int width, int index) = 0;
+
+    private:
+        void drawRows(Device* device, int y_start, int y_end);
+
+    private:
+        int position_{0};
+        int drawn_position_{0};
+        bool valid_{false};
+        uint8_t page_buffer_[MAX_WIDTH];
+
+    public:
+        VerticalScroller(const VerticalScroller&) = delete;
+        VerticalScroller(const VerticalScroller&&) = delete;
+        VerticalScroller& operator=(const VerticalScroller&) = delete;
+        VerticalScroller& operator=(const VerticalScroller&&) = delete;
+};
+
+}  // namespace graphics
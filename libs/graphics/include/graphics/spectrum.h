@@ -0,0 +1,149 @@
+//
+// Spectrum
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace graphics {
+
+class Display;
+
+/**
+ * FFT window function
+ */
+enum class Window {
+    Rectangular,
+    Hann,
+    Hamming,
+    Blackman
+};
+
+/**
+ * Spectrum rendering
+ */
+enum class SpectrumStyle {
+    Bars,
+    Line
+};
+
+/**
+ * Spectrum analyzer. Radix-2 fixed-point FFT (Q15, scaled by 1/2 per
+ * stage), magnitudes in dB via a log2 lookup table, with level decay and
+ * peak hold per bin. The transform runs in steps limited by a time budget,
+ * so a large FFT can be spread across several frames.
+ */
+class Spectrum {
+    public:
+        static const int MAX_POINTS = 512;
+        static const int MAX_BINS = MAX_POINTS / 2;
+
+    public:
+        Spectrum();
+
+    public:
+        /**
+         * @brief   Set FFT size
+         * @param   points  128, 256 or 512
+         * @return  true on success
+         */
+        bool setPoints(int points);
+        int getPoints() const;
+
+        void setWindow(Window window);
+        Window getWindow() const;
+
+        void setStyle(SpectrumStyle style);
+        SpectrumStyle getStyle() const;
+
+        /**
+         * @brief   Set displayed dynamic range
+         * @param   floor_db    Bottom of the display in dB below full scale (e.g. -72)
+         */
+        void setRange(int floor_db);
+
+        /**
+         * @brief   Set level smoothing and peak hold
+         * @param   decay_db    Level fall per spectrum in dB
+         * @param   hold        Spectra a peak is held before falling
+         */
+        void setPeakHold(int decay_db, int hold);
+
+        /**
+         * @brief   Limit processing time per process() call, 0 runs to completion
+         */
+        void setTimeBudget(uint32_t budget_us);
+
+    public:
+        /**
+         * @brief   Start a transform of the newest samples
+         * @param   ring        Sample ring
+         * @param   ring_size   Ring size
+         * @param   end         Ring position after the newest sample
+         * @return  false if busy or not enough samples
+         */
+        bool start(const int* ring, size_t ring_size, size_t end);
+
+        /**
+         * @brief   Continue the transform within the time budget
+         * @return  true when a new spectrum is complete
+         */
+        bool process();
+
+        bool isBusy() const;
+        int getPeakBin() const;         // strongest bin of the last spectrum
+        int getLevel(int bin) const;    // level in 0.1 dB
+        void reset();
+
+    public:
+        void draw(Display* display, int x1, int y1, int x2, int y2);
+
+    private:
+        enum class Stage {
+            Idle,
+            Butterflies,
+            Magnitude
+        };
+
+        void computeTables();
+        bool butterflies(size_t count);
+        bool magnitudes(size_t count);
+        void finish();
+        static int toDecibel(uint32_t power);
+
+    private:
+        int points_{256};
+        int log2_points_{8};
+        Window window_{Window::Hann};
+        SpectrumStyle style_{SpectrumStyle::Bars};
+        int floor_db10_{-720};
+        int decay_db10_{30};
+        int hold_{10};
+        uint32_t budget_us_{0};
+
+        Stage stage_{Stage::Idle};
+        int stage_span_{1};             // half size of the current butterfly groups
+        size_t position_{0};            // butterfly or bin within the current stage
+        int peak_bin_{0};
+
+        int16_t re_[MAX_POINTS];
+        int16_t im_[MAX_POINTS];
+        int16_t window_table_[MAX_POINTS];
+        int16_t cos_[MAX_BINS];         // twiddle factors for MAX_POINTS
+        int16_t sin_[MAX_BINS];
+
+        int16_t power_db10_[MAX_BINS];  // last transform
+        int16_t level_db10_[MAX_BINS];  // smoothed
+        int16_t peak_db10_[MAX_BINS];   // held peaks
+        uint8_t peak_age_[MAX_BINS];
+
+    public:
+        Spectrum(const Spectrum&) = delete;
+        Spectrum(const Spectrum&&) = delete;
+        Spectrum& operator=(const Spectrum&) = delete;
+        Spectrum& operator=(const Spectrum&&) = delete;
+        ~Spectrum() = default;
+};
+
+}  // namespace graphics
@@ -0,0 +1,100 @@
+//
+// Sprites
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "graphics/base.h"
+
+namespace graphics {
+
+class Bitmap;
+class Display;
+
+/**
+ * Software sprites drawn into the device framebuffer. The background
+ * below each sprite is saved before drawing and restored when the sprite
+ * moves, changes its frame or is hidden, so only the union of the old and
+ * new sprite area needs to be redrawn and refreshed.
+ * Sprites are drawn in the order of their ids, higher ids on top.
+ */
+class SpriteManager {
+    public:
+        static const int MAX_SPRITES = 8;
+
+    public:
+        explicit SpriteManager(Display* display);
+
+    public:
+        /**
+         * @brief   Create sprite
+         * @param   frames      Animation frames (bitmaps, alpha channel is used if present)
+         * @param   num_frames  Number of frames
+         * @return  Sprite id, or -1 if no sprite is available
+         */
+        int create(const Bitmap* const* frames, size_t num_frames);
+
+        /**
+         * @brief   Destroy sprite, its background is restored with the next update()
+         * @param   id  Sprite id
+         */
+        void destroy(int id);
+
+        void setPosition(int id, int x, int y);
+        void setFrame(int id, int frame);
+        void setVisible(int id, bool visible);
+
+        int getFrame(int id) const;
+        int getNumFrames(int id) const;
+
+        /**
+         * @brief   Move sprites to their new state. Restores the backgrounds,
+         *          then saves and draws the sprites and marks the union of old
+         *          and new areas of the changed sprites.
+         */
+        void update();
+
+        /**
+         * @brief   Remove all sprites from the framebuffer. Call before drawing
+         *          to the background, sprites reappear with the next update().
+         */
+        void restore();
+
+    private:
+        struct Sprite {
+            bool used{false};
+            bool visible{true};
+            bool changed{false};
+            bool drawn{false};                  // background saved, sprite in framebuffer
+            bool release{false};                // destroyed, free after restore
+            const Bitmap* const* frames{nullptr};
+            size_t num_frames{0};
+            int frame{0};
+            int x{0};
+            int y{0};
+            Rectangle saved_rect;               // saved area, page aligned
+            std::vector<uint8_t> saved;         // saved background bytes
+        };
+
+        Sprite* get(int id);
+        const Sprite* get(int id) const;
+        bool getArea(const Sprite& sprite, Rectangle& area) const;
+        void saveBackground(Sprite& sprite, const Rectangle& area);
+        void restoreBackground(Sprite& sprite);
+
+    private:
+        Display* display_;
+        Sprite sprites_[MAX_SPRITES];
+
+    public:
+        SpriteManager(const SpriteManager&) = delete;
+        SpriteManager(const SpriteManager&&) = delete;
+        SpriteManager& operator=(const SpriteManager&) = delete;
+        SpriteManager& operator=(const SpriteManager&&) = delete;
+        ~SpriteManager() = default;
+};
+
+}  // namespace graphics
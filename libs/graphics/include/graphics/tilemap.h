@@ -0,0 +1,126 @@
+//
+// Tile Map
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "graphics/scroller.h"
+
+namespace graphics {
+
+class Device;
+
+/**
+ * Tile map playfield. Tiles are 8x8 pixels in the native page format of
+ * the panel (8 bytes per tile, one byte per column, bit 0 is the top row).
+ * A software camera selects the visible part of the map at pixel precision,
+ * tile columns are copied into the framebuffer with byte shifts.
+ *
+ * With hardware scrolling enabled the playfield covers the whole panel and
+ * is drawn by the VerticalScroller base: vertical camera moves only set the
+ * start line and redraw the rows that scrolled into view. Horizontal moves
+ * always redraw the viewport.
+ */
+class TileMap : public VerticalScroller {
+    public:
+        static const int TILE_SIZE = 8;
+
+    public:
+        TileMap();
+
+    public:
+        /**
+         * @brief   Set tile set
+         * @param   tiles       Tile data, TILE_SIZE bytes per tile
+         * @param   num_tiles   Number of tiles
+         */
+        void setTiles(const uint8_t* tiles, size_t num_tiles);
+
+        /**
+         * @brief   Set tile index map
+         * @param   map         Tile indices, row by row
+         * @param   width       Map width in tiles
+         * @param   height      Map height in tiles
+         */
+        void setMap(const uint8_t* map, int width, int height);
+
+        /**
+         * @brief   Repeat the map beyond its borders, otherwise outside is empty
+         */
+        void setWrap(bool wrap);
+
+        /**
+         * @brief   Set screen area of the playfield (software scrolling only),
+         *          the part outside of the panel is not drawn
+         * @param   left        First column
+         * @param   right       Last column
+         * @param   first_page  First page
+         * @param   last_page   Last page
+         */
+        void setViewport(int left, int right, int first_page, int last_page);
+
+        /**
+         * @brief   Set camera position (top left corner of the viewport in map pixels)
+         */
+        void setCamera(int x, int y);
+        int cameraX() const;
+        int cameraY() const;
+
+        /**
+         * @brief   Use the start line register for vertical scrolling.
+         *          The playfield covers the whole panel while enabled.
+         */
+        void setHardwareScroll(bool enable);
+        bool isHardwareScroll() const;
+
+        /**
+         * @brief   Redraw all of the viewport with the next draw()
+         */
+        void invalidate();
+
+        /**
+         * @brief   Render changed parts of the playfield into the framebuffer
+         *          and mark them for refresh
+         * @param   device  Target device
+         */
+        void draw(Device* device);
+
+    protected:
+        void renderPage(uint8_t* dest, int width, int index) override;
+
+    private:
+        const uint8_t* tile(int tx, int ty) const;
+        void drawPageRows(uint8_t* dest, int world_y, int left, int right);
+        void drawAll(Device* device);
+
+    private:
+        const uint8_t* tiles_{nullptr};
+        size_t num_tiles_{0};
+        const uint8_t* map_{nullptr};
+        int map_width_{0};
+        int map_height_{0};
+        bool wrap_{true};
+
+        int left_{0};
+        int right_{127};
+        int first_page_{0};
+        int last_page_{7};
+
+        int camera_x_{0};
+        int camera_y_{0};
+        int drawn_x_{0};                // camera of the framebuffer content
+        int drawn_y_{0};
+        bool valid_{false};
+        bool hardware_scroll_{false};
+
+    public:
+        TileMap(const TileMap&) = delete;
+        TileMap(const TileMap&&) = delete;
+        TileMap& operator=(const TileMap&) = delete;
+        TileMap& operator=(const TileMap&&) = delete;
+        ~TileMap() = default;
+};
+
+}  // namespace graphics
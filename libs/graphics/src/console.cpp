@@ -0,0 +1,389 @@
+//
+// Console
+//
+#include "graphics/console.h"
+#include "graphics/device.h"
+
+#include <memory.h>
+#include <algorithm>
+#include <cstdio>
+
+#include "freertos/semphr.h"
+#include "esp_log.h"
+
+#include "sys/trace.h"
+
+using namespace graphics;
+
+namespace {
+
+const TickType_t LOG_LOCK_TICKS = pdMS_TO_TICKS(10);   // give up instead of blocking the logging task
+
+Console* log_console = nullptr;
+vprintf_like_t log_vprintf = nullptr;
+
+}  // namespace
+
+Console::Console() {
+    mutex_ = xSemaphoreCreateMutex();
+    setFont(BUILTIN_FONTS[0]);
+    clear();
+}
+
+Console::~Console() {
+    if (log_console == this) {
+        attachLog(nullptr);
+    }
+
+    if (nullptr != mutex_) {
+        vSemaphoreDelete(mutex_);
+    }
+}
+
+// ############################################################################
+// Setup
+// ############################################################################
+
+bool Console::setFont(const Font* font) {
+    if (nullptr == font || font->height > 8) {
+        return false;
+    }
+
+    int max_width = 0;
+    for (int c = std::max((int) font->char_start, 0x20); c <= std::min((int) font->char_end, 0x7e); c++) {
+        max_width = std::max(max_width, (int) font->char_descriptors[c - font->char_start].width);
+    }
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    font_ = font;
+    cell_width_ = std::max(1, max_width + font->c);
+    columns_ = std::min((int) MAX_COLUMNS, VerticalScroller::MAX_WIDTH / cell_width_);
+    valid_ = false;
+    xSemaphoreGive(mutex_);
+
+    return true;
+}
+
+void Console::setViewport(int first_page, int last_page) {
+    first_page_ = first_page;
+    last_page_ = last_page;
+    valid_ = false;
+}
+
+void Console::setHardwareScroll(bool enable) {
+    if (hardware_scroll_ == enable) return;
+    hardware_scroll_ = enable;
+    valid_ = false;
+}
+
+bool Console::isHardwareScroll() const {
+    return hardware_scroll_;
+}
+
+int Console::columns() const {
+    return columns_;
+}
+
+// ############################################################################
+// Text
+// ############################################################################
+
+Console::Line& Console::line(int number) {
+    return lines_[floorMod(number, MAX_LINES)];
+}
+
+bool Console::isStored(int number) const {
+    return (number >= 0 && number <= current_ && number > current_ - MAX_LINES);
+}
+
+void Console::resetLine(int number) {
+    auto& l = line(number);
+    l.length = 0;
+    l.dirty_first = 0;
+    l.dirty_last = -1;
+}
+
+void Console::clear() {
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    for (int i = 0; i < MAX_LINES; i++) {
+        resetLine(i);
+    }
+    current_ = 0;
+    column_ = 0;
+    pending_newline_ = false;
+    escape_ = false;
+    valid_ = false;
+    xSemaphoreGive(mutex_);
+}
+
+void Console::newLine() {
+    current_++;
+    resetLine(current_);
+    column_ = 0;
+}
+
+void Console::put(char c) {
+    if (escape_) {
+        // CSI sequences end with a letter
+        if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')) escape_ = false;
+        return;
+    }
+
+    if ('\n' == c) {
+        if (pending_newline_) newLine();
+        pending_newline_ = true;
+        return;
+    }
+
+    if ('\x1b' == c) {
+        escape_ = true;
+        return;
+    }
+
+    if (pending_newline_) {
+        newLine();
+        pending_newline_ = false;
+    }
+
+    if ('\r' == c) {
+        column_ = 0;
+        return;
+    }
+
+    if ('\b' == c) {
+        if (column_ > 0) column_--;
+        return;
+    }
+
+    if ('\t' == c) {
+        do { put(' '); } while (0 != column_ % 4);
+        return;
+    }
+
+    if ((uint8_t) c < 0x20) {
+        return;
+    }
+
+    if (column_ >= columns_) {
+        newLine();
+    }
+
+    auto& l = line(current_);
+    l.text[column_] = c;
+    if (column_ >= l.length) l.length = (uint8_t) (column_ + 1);
+
+    if (l.dirty_first > l.dirty_last) {
+        l.dirty_first = (int8_t) column_;
+        l.dirty_last = (int8_t) column_;
+    } else {
+        l.dirty_first = (int8_t) std::min((int) l.dirty_first, column_);
+        l.dirty_last = (int8_t) std::max((int) l.dirty_last, column_);
+    }
+
+    column_++;
+}
+
+void Console::writeText(const char* str, size_t len) {
+    for (size_t i = 0; i < len && '\0' != str[i]; i++) {
+        put(str[i]);
+    }
+}
+
+void Console::write(const char* str, size_t len) {
+    if (nullptr == str) return;
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+    writeText(str, len);
+    xSemaphoreGive(mutex_);
+}
+
+void Console::print(const char* str) {
+    if (nullptr == str) return;
+    write(str, strlen(str));
+}
+
+int Console::printf(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    auto result = vprintf(format, args);
+    va_end(args);
+    return result;
+}
+
+int Console::vprintf(const char* format, va_list args) {
+    char buffer[128];
+    auto result = vsnprintf(buffer, sizeof(buffer), format, args);
+    if (result > 0) {
+        write(buffer, std::min((size_t) result, sizeof(buffer) - 1));
+    }
+    return result;
+}
+
+// ############################################################################
+// Log output
+// ############################################################################
+
+void Console::attachLog(Console* console) {
+    if (nullptr != console && nullptr == log_console) {
+        log_vprintf = esp_log_set_vprintf(&Console::logVprintf);
+    } else if (nullptr == console && nullptr != log_console) {
+        esp_log_set_vprintf(log_vprintf);
+        log_vprintf = nullptr;
+    }
+
+    log_console = console;
+}
+
+int Console::logVprintf(const char* format, va_list args) {
+    int result = 0;
+
+    if (nullptr != log_vprintf) {
+        va_list copy;
+        va_copy(copy, args);
+        result = log_vprintf(format, copy);   // keep the serial output
+        va_end(copy);
+    }
+
+    auto console = log_console;
+    if (nullptr == console) {
+        return result;
+    }
+
+    char buffer[128];
+    auto len = vsnprintf(buffer, sizeof(buffer), format, args);
+    if (len <= 0) {
+        return result;
+    }
+
+    // logging while the console is drawn (or busy) drops the console copy
+    if (pdTRUE == xSemaphoreTake(console->mutex_, LOG_LOCK_TICKS)) {
+        console->writeText(buffer, std::min((size_t) len, sizeof(buffer) - 1));
+        xSemaphoreGive(console->mutex_);
+    }
+
+    return result;
+}
+
+// ############################################################################
+// Rendering
+// ############################################################################
+
+void Console::renderCells(uint8_t* dest, const Line& line, int first, int last) const {
+
+    // transpose the row based font bitmap into page columns
+
+    for (int col = first; col <= last; col++) {
+        auto out = dest + col * cell_width_;
+        memset(out, 0x0, cell_width_);
+
+        int c = (col < line.length) ? (uint8_t) line.text[col] : ' ';
+        if (c < font_->char_start || c > font_->char_end) c = ' ';
+
+        const auto& desc = font_->char_descriptors[c - font_->char_start];
+        auto bitmap = font_->bitmap + desc.offset;
+        auto stride = (desc.width + 7) / 8;
+        auto width = std::min((int) desc.width, cell_width_);
+
+        for (int row = 0; row < font_->height; row++) {
+            auto bits = bitmap + row * stride;
+            for (int x = 0; x < width; x++) {
+                if (0x0 != (bits[x / 8] & (0x80 >> (x % 8)))) {
+                    out[x] |= (uint8_t) (1 << row);
+                }
+            }
+        }
+    }
+}
+
+void Console::renderPage(uint8_t* dest, int width, int index) {
+    memset(dest, 0x0, width);
+
+    if (!isStored(index)) return;
+
+    auto& l = line(index);
+    if (l.length > 0) {
+        renderCells(dest, l, 0, l.length - 1);
+    }
+
+    l.dirty_first = 0;
+    l.dirty_last = -1;
+}
+
+void Console::draw(Device* device) {
+    TRACE_SCOPE("console.draw");
+
+    if (nullptr == device) return;
+
+    xSemaphoreTake(mutex_, portMAX_DELAY);
+
+    auto width = device->width();
+    auto num_pages = device->height() / 8;
+
+    // the viewport is limited to the panel, the configured pages are kept
+
+    auto first_page = std::min(std::max(0, first_page_), num_pages - 1);
+    auto last_page = std::min(std::max(first_page, last_page_), num_pages - 1);
+
+    auto rows = hardware_scroll_ ? num_pages : last_page - first_page + 1;
+    auto top = std::max(0, current_ - rows + 1);
+
+    if (hardware_scroll_) {
+
+        // new lines come in as pages rendered by the scroller
+
+        if (!valid_) VerticalScroller::invalidate();
+        setPosition(top * 8);
+        update(device);
+
+    } else if (!valid_ || top < top_ || top - top_ >= rows) {
+
+        if (!valid_) device->setVerticalOffset(0);
+
+        for (int page = first_page; page <= last_page; page++) {
+            memset(device->buffer() + page * width, 0x0, width);
+            device->markRegion(0, width - 1, page * 8);
+        }
+
+        for (int number = top; number <= current_; number++) {
+            auto& l = line(number);
+            l.dirty_first = 0;
+            l.dirty_last = (int8_t) (l.length - 1);
+        }
+
+    } else if (top > top_) {
+
+        // shift the viewport pages up, then draw the new lines
+
+        auto shift = top - top_;
+        auto buffer = device->buffer();
+        memmove(buffer + first_page * width, buffer + (first_page + shift) * width, (rows - shift) * width);
+        memset(buffer + (last_page - shift + 1) * width, 0x0, shift * width);
+
+        for (int page = first_page; page <= last_page; page++) {
+            device->markRegion(0, width - 1, page * 8);
+        }
+
+        for (int number = top + rows - shift; number <= current_; number++) {
+            auto& l = line(number);
+            l.dirty_first = 0;
+            l.dirty_last = (int8_t) (l.length - 1);
+        }
+    }
+
+    for (int number = top; number <= current_; number++) {
+        auto& l = line(number);
+        if (l.dirty_first > l.dirty_last) continue;
+
+        auto page = hardware_scroll_ ? floorMod(number, num_pages) : first_page + (number - top);
+        renderCells(device->buffer() + page * width, l, l.dirty_first, l.dirty_last);
+        device->markRegion(l.dirty_first * cell_width_, (l.dirty_last + 1) * cell_width_ - 1, page * 8);
+
+        l.dirty_first = 0;
+        l.dirty_last = -1;
+    }
+
+    top_ = top;
+    valid_ = true;
+
+    xSemaphoreGive(mutex_);
+}
@@ -7,7 +7,11 @@
 #include <stdint.h>
 
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "graphics/bits.h"
+#include "sys/trace.h"
 
 static const uint8_t DEFAULT_GPIO_ADDRESS = 0x78;
 static const int DEFAULT_GPIO_PIN_SDA_DATA = 21;
@@ -29,7 +33,12 @@ Device::Device(int scl, int sda, PanelType type, uint8_t address)
       height_(0),
       num_pages_(0),
       partial_updates_enabled_(true),
-      frequency_(0.0f) {
+      frequency_(0.0f),
+      refresh_mode_(RefreshMode::Immediate),
+      start_line_(0),
+      scan_epoch_us_(0),
+      scan_period_us_(0),
+      page_transfer_us_(0) {
 
     i2c = new sys::I2C(scl, sda, address);
 
@@ -101,12 +110,15 @@ bool Device::init() {
     int num_disp_clocks_per_row = 54;  // (2 + 2 + 50)
     int clock_ticks_per_frame = (clock_divide_ratio + 1) * (int) height_ * num_disp_clocks_per_row;
     frequency_ = osc_frequency_value / (float)(clock_ticks_per_frame);
+    scan_period_us_ = (int64_t) (1000000.0f / frequency_);
+    page_transfer_us_ = scan_period_us_ / num_pages_;  // refined by measurement
 
     command(Command::SetMultiplexRatio);        // SSD1306_SETMULTIPLEX
     command(height_ - 1);                       // multiplex ratio: 1/64 or 1/32
     command(Command::SetDisplayOffset);         // SSD1306_SETDISPLAYOFFSET
     command(0x00);                              // 0 no display offset (default)
     command(static_cast<uint8_t>(Command::SetStartLine) + 0);         // SSD1306_SETSTARTLINE line #0
+    start_line_ = 0;
 
     if (type_ == PanelType::SSD1306_128x32) {
         command(Command::ChargePumpSetting);
@@ -149,6 +161,7 @@ bool Device::init() {
     refresh(true);
 
     command(Command::SetDisplayOn);
+    calibrateScan(esp_timer_get_time()); // row scan starts with display on
 
     return true;
 }
@@ -158,6 +171,28 @@ void Device::setVerticalOffset(int ofs) {
     if (ofs >= height_) ofs = height_ - 1;
 
     command(0x40 | (uint8_t)ofs);
+    start_line_ = (uint8_t) ofs;
+}
+
+void Device::setRefreshMode(RefreshMode mode) {
+    refresh_mode_ = mode;
+}
+
+RefreshMode Device::refreshMode() const {
+    return refresh_mode_;
+}
+
+void Device::calibrateScan(int64_t frame_start_us) {
+    scan_epoch_us_ = frame_start_us;
+}
+
+int Device::scanPosition(int64_t time_us) const {
+    if (scan_period_us_ <= 0) return -1;
+
+    int64_t phase = (time_us - scan_epoch_us_) % scan_period_us_;
+    if (phase < 0) phase += scan_period_us_;
+
+    return (int) (phase * height_ / scan_period_us_);
 }
 
 float Device::frequency() const {
@@ -298,7 +333,11 @@ void Device::refresh() {
 }
 
 void Device::refresh(bool force) {
-    if (force) {
+    TRACE_SCOPE("device.refresh");
+
+    if (RefreshMode::ScanSynchronized == refresh_mode_ && scan_period_us_ > 0) {
+        refreshScanSynchronized(force);
+    } else if (force) {
 
         uint8_t buffer[] = {
             static_cast<uint8_t>(Command::SetColumnAddress), 0, (uint8_t) (width_ - 1),
@@ -318,6 +357,63 @@ void Device::refresh(bool force) {
     clearRegions();
 }
 
+void Device::refreshScanSynchronized(bool force) {
+
+    // pages in scan order, starting with the page the scan has just left
+    int band = scanPosition(esp_timer_get_time()) / 8;
+    int last_band = (band + num_pages_ - 1) % num_pages_;
+    int first_page = ((last_band * 8 + start_line_ + 7) / 8) % num_pages_;
+
+    for (int i = 0; i < num_pages_; i++) {
+        int page = (first_page + i) % num_pages_;
+        auto &page_info = page_info_[page];
+
+        if (force) {
+            page_info.dirty_left = 0;
+            page_info.dirty_right = width_ - 1;
+        } else if (page_info.lock || page_info.dirty_right < page_info.dirty_left) {
+            continue;
+        }
+
+        // scan times of the page within a frame
+        int first_row = (page * 8 - start_line_ + height_) % height_;
+        int64_t enter_ofs = first_row * scan_period_us_ / height_;
+        int64_t leave_ofs = ((first_row + 8) * scan_period_us_ + height_ - 1) / height_;
+
+        int bytes = page_info.dirty_right - page_info.dirty_left + 1;
+        int64_t transfer_us = page_transfer_us_ * bytes / width_ + scan_period_us_ / height_;  // one row margin
+
+        // the transfer has to complete before the scan's next pass over the page,
+        // otherwise it starts when the scan leaves the page once more
+        int64_t now = esp_timer_get_time();
+        int64_t phase = (now - scan_epoch_us_) % scan_period_us_;
+        if (phase < 0) phase += scan_period_us_;
+        int64_t left = now - phase + leave_ofs;
+        if (left > now) left -= scan_period_us_;
+        int64_t next_enter = left + scan_period_us_ - (leave_ofs - enter_ofs);
+        int64_t ready = (now + transfer_us <= next_enter) ? now : left + scan_period_us_;
+
+        // bounded by one scan period: whole ticks block the task, the rest
+        // (less than a tick) is a short busy wait
+        int64_t tick_us = (int64_t) portTICK_PERIOD_MS * 1000;
+        now = esp_timer_get_time();
+        if (ready - now >= tick_us) {
+            vTaskDelay((TickType_t) ((ready - now) / tick_us));
+            now = esp_timer_get_time();
+        }
+        if (ready > now) {
+            ets_delay_us((uint32_t) (ready - now));
+            now = esp_timer_get_time();
+        }
+
+        refreshPage(page, true);
+
+        // keep a running estimate of the transfer time of a full page
+        int64_t elapsed = esp_timer_get_time() - now;
+        page_transfer_us_ = (page_transfer_us_ * 3 + elapsed * width_ / bytes) / 4;
+    }
+}
+
 void Device::refreshPage(int page, bool force) {
     if (page < 0 || page >= num_pages_) {
         return;
@@ -332,6 +428,8 @@ void Device::refreshPage(int page, bool force) {
         return;
     }
 
+    TRACE_SCOPE("device.page");
+
     // ESP_LOGI("graphics", "draw region/page %d: %d - %d", page, region.first,
     // region.second);
 
@@ -4,12 +4,16 @@
 #include "graphics/base.h"
 #include "graphics/bitmap.h"
 #include "graphics/display.h"
+#include "graphics/format.h"
+#include "graphics/layer.h"
 
 #include <memory.h>
 #include <stdint.h>
 #include <algorithm>
+#include <cstring>
 
 #include "esp_log.h"
+#include "sys/trace.h"
 
 using namespace graphics;
 
@@ -73,6 +77,29 @@ int Display::height() {
     return height_;
 }
 
+Layer* Display::setLayer(Layer* layer) {
+    auto old = layer_;
+    layer_ = layer;
+
+    if (nullptr != layer_) {
+        width_ = (uint8_t) std::min(layer_->width(), 255);
+        height_ = (uint8_t) std::min(layer_->height(), 255);
+    } else {
+        width_ = device_->width();
+        height_ = device_->height();
+    }
+
+    return old;
+}
+
+Layer* Display::layer() const {
+    return layer_;
+}
+
+SpriteManager& Display::sprites() {
+    return sprites_;
+}
+
 // ############################################################################
 // Colors
 // ############################################################################
@@ -101,6 +128,19 @@ Color Display::getBackground() const {
 // Low-level drawing
 // ############################################################################
 
+inline uint8_t* Display::targetBuffer() {
+    return (nullptr != layer_) ? layer_->buffer() : device_->buffer();
+}
+
+template <typename... Args>
+inline void Display::markDirty(Args... args) {
+    if (nullptr != layer_) {
+        layer_->markRegion(args...);
+    } else {
+        device_->markRegion(args...);
+    }
+}
+
 inline uint8_t Display::getPixelMask(int y) const {
     return (1 << (y & 7));
 }
@@ -116,7 +156,7 @@ void Display::drawPixelClipped(int x, int y, Color color) {
 
 void Display::drawPixelRaw(int x, int y, Color color) {
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
 
     uint8_t dest_bit = getPixelMask(y);
     uint16_t index = getPixelOffset(x, y);
@@ -141,26 +181,30 @@ void Display::drawPixelRaw(int x, int y, Color color) {
 // ############################################################################
 
 void Display::clear() {
-    device_->clear();
+    if (nullptr != layer_) {
+        layer_->clear();
+    } else {
+        device_->clear();
+    }
 }
 
 void Display::drawPixel(int x, int y) {
     if ((x >= width_) || (x < 0) || (y >= height_) || (y < 0)) return;
     drawPixelRaw(x, y, foreground_);
-    device_->markRegion(x, y);
+    markDirty(x, y);
 }
 
 void Display::drawPixel(int x, int y, Color color) {
     if ((x >= width_) || (x < 0) || (y >= height_) || (y < 0)) return;
     drawPixelRaw(x, y, color);
-    device_->markRegion(x, y);
+    markDirty(x, y);
 }
 
 void Display::drawHorizontalLine(int x, int y, int x2) {
     uint16_t index;
     uint8_t mask, t;
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
 
     sort_pair(x, x2);
     uint8_t w = x2 - x + 1;
@@ -211,14 +255,14 @@ void Display::drawHorizontalLine(int x, int y, int x2) {
             break;
     }
 
-    device_->markRegion(x, x + w - 1, y, y);
+    markDirty(x, x + w - 1, y, y);
 }
 
 void Display::drawVerticalLine(int x, int y, int y2) {
     int index;
     uint8_t mask, mod, t;
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
 
     sort_pair(y, y2);
     int h = y2 - y + 1;
@@ -254,7 +298,7 @@ void Display::drawVerticalLine(int x, int y, int y2) {
         }
 
         if (t < mod) {
-            device_->markRegion(x, x, y, y + h - 1);
+            markDirty(x, x, y, y + h - 1);
             return;
         }
 
@@ -309,7 +353,7 @@ void Display::drawVerticalLine(int x, int y, int y2) {
         }
     }
 
-    device_->markRegion(x, x, y, y + h - 1);
+    markDirty(x, x, y, y + h - 1);
 
     return;
 }
@@ -326,7 +370,7 @@ void Display::drawLine(int x, int y, int x2, int y2) {
         return;
     }
 
-    device_->markRegion(std::min(x, x2), std::max(x, x2), std::min(y, y2), std::max(y, y2));
+    markDirty(std::min(x, x2), std::max(x, x2), std::min(y, y2), std::max(y, y2));
 
     bool vertical = false;
     int short_length = y2 - y;
@@ -571,48 +615,70 @@ int Display::drawChar(int x, int y, int c) {
 }
 
 int Display::drawString(int x, int y, const std::string &str) {
-    return drawString(x, y, str.c_str());
+    return drawString(x, y, str.c_str(), str.length());
 }
 
 int Display::drawString(int x, int y, const char *str) {
+    if (str == nullptr) {
+        return 0;
+    }
+
+    return drawString(x, y, str, strlen(str));
+}
+
+int Display::drawString(int x, int y, const char *str, size_t length) {
     int t = x;
 
     if (font_ == nullptr) {
         return 0;
     }
 
-    if (str == nullptr || *str == '\0') {
+    if (str == nullptr || length == 0) {
         return 0;
     }
 
-    while (*str) {
-        x += drawChar(x, y, *str);
-        ++str;
-        if (*str) x += font_->c;
+    for (size_t i = 0; i < length; i++) {
+        if (i > 0) x += font_->c;
+        x += drawChar(x, y, (unsigned char) str[i]);
     }
 
     return (x - t);
 }
 
+int Display::drawString(int x, int y, int value, int width, char pad) {
+    TextBuffer<16> text;
+    text.appendInt(value, width, pad);
+    return drawString(x, y, text.c_str(), text.length());
+}
+
 // return width of string
 int Display::measureString(const std::string &str) {
-    return measureString(str.c_str());
+    return measureString(str.c_str(), str.length());
 }
 
 // return width of string
 int Display::measureString(const char *str) {
+    if (str == nullptr) {
+        return 0;
+    }
+
+    return measureString(str, strlen(str));
+}
+
+// return width of string
+int Display::measureString(const char *str, size_t length) {
     if (font_ == nullptr) {
         return 0;
     }
 
-    if (str == nullptr || *str == '\0') {
+    if (str == nullptr || length == 0) {
         return 0;
     }
 
     int w = 0;
 
-    while (*str) {
-        unsigned char c = *str;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = str[i];
         // we always have space in the font set
         if ((c < font_->char_start) || (c > font_->char_end)) {
             c = ' ';
@@ -620,8 +686,7 @@ int Display::measureString(const char *str) {
 
         c = c - font_->char_start;  // c now become index to tables
         w += font_->char_descriptors[c].width;
-        ++str;
-        if (*str) {
+        if (i + 1 < length) {
             w += font_->c;
         }
     }
@@ -657,7 +722,7 @@ void Display::drawBitmap(const Bitmap* bitmap,
 
     if (bitmap == nullptr) return;
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
     auto pixels = bitmap->getPixelBytes();
     int height = bitmap->height();
     int width = bitmap->width();
@@ -699,7 +764,7 @@ void Display::drawBitmap(const Bitmap* bitmap,
     if (y < 0) y = 0;
     if (x < 0) x = 0;
 
-    device_->markRegion(x, x + width - 1, y, y + height - 1);
+    markDirty(x, x + width - 1, y, y + height - 1);
 
     int dest_y = y;
     for (int j = y_src_min; j <= y_src_max; ++j) {
@@ -761,7 +826,7 @@ void Display::drawStretchBitmap(const Bitmap* bitmap,
 
     if (bitmap == nullptr) return;
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
     auto pixels = bitmap->getPixelBytes();
     bool has_alpha = bitmap->hasAlpha();
     int bits_per_pixels = has_alpha ? 2 : 1;
@@ -770,7 +835,7 @@ void Display::drawStretchBitmap(const Bitmap* bitmap,
     Rectangle clipped_dest = dest_rect;
     clipped_dest.clip(0, width()-1, 0, height()-1);
 
-    device_->markRegion(clipped_dest);
+    markDirty(clipped_dest);
 
     auto src_left = src_rect.left;
     auto src_top = src_rect.top;
@@ -859,6 +924,8 @@ void Display::update(bool force) {
 }
 
 void Display::refresh() {
+    TRACE_SCOPE("display.refresh");
+
     if (update_state_ == UPDATE_NEEDED) {
         device_->refresh();
     } else if (update_state_ == FORCED_UPDATE) {
@@ -924,7 +991,7 @@ void Display::drawDitheredHorizontalLine(int x, int y, int x2, int intensity) {
     uint16_t index;
     uint8_t mask, t;
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
 
     sort_pair(x, x2);
     uint8_t w = x2 - x + 1;
@@ -963,7 +1030,7 @@ void Display::drawDitheredHorizontalLine(int x, int y, int x2, int intensity) {
         ++x;
     }
 
-    device_->markRegion(x, x + w - 1, y, y);
+    markDirty(x, x + w - 1, y, y);
 }
 
 
@@ -981,7 +1048,7 @@ void Display::drawPatternHorizontalLine(int x, int y, int x2, uint32_t pattern)
     uint16_t index;
     uint8_t mask, t;
 
-    auto buffer = device_->buffer();
+    auto buffer = targetBuffer();
 
     sort_pair(x, x2);
     uint8_t w = x2 - x + 1;
@@ -1023,7 +1090,7 @@ void Display::drawPatternHorizontalLine(int x, int y, int x2, uint32_t pattern)
         ++x;
     }
 
-    device_->markRegion(x, x + w - 1, y, y);
+    markDirty(x, x + w - 1, y, y);
 }
 
 void Display::fillDitheredRectangle(int x, int y, int x2, int y2, int intensity) {
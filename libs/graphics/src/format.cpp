@@ -0,0 +1,117 @@
+//
+// Text Formatting
+//
+
+#include "graphics/format.h"
+
+using namespace graphics;
+
+static const uint32_t POWERS_OF_TEN[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+static const int MAX_DECIMALS = 6;
+
+Formatter::Formatter(char* buffer, size_t size) : buffer_(buffer), size_(size) {
+    if (size_ > 0) buffer_[0] = '\0';
+}
+
+Formatter& Formatter::clear() {
+    length_ = 0;
+    if (size_ > 0) buffer_[0] = '\0';
+    return *this;
+}
+
+const char* Formatter::c_str() const {
+    return buffer_;
+}
+
+size_t Formatter::length() const {
+    return length_;
+}
+
+Formatter& Formatter::append(char c) {
+    if (length_ + 1 < size_) {
+        buffer_[length_++] = c;
+        buffer_[length_] = '\0';
+    }
+    return *this;
+}
+
+Formatter& Formatter::append(const char* str) {
+    if (nullptr == str) return *this;
+
+    while (*str && length_ + 1 < size_) {
+        buffer_[length_++] = *str++;
+    }
+    if (size_ > 0) buffer_[length_] = '\0';
+    return *this;
+}
+
+Formatter& Formatter::append(const char* str, size_t length) {
+    if (nullptr == str) return *this;
+
+    for (size_t i = 0; i < length && length_ + 1 < size_; i++) {
+        buffer_[length_++] = str[i];
+    }
+    if (size_ > 0) buffer_[length_] = '\0';
+    return *this;
+}
+
+Formatter& Formatter::appendInt(int32_t value, int width, char pad) {
+    bool negative = (value < 0);
+    uint32_t magnitude = negative ? 0u - (uint32_t) value : (uint32_t) value;
+    return appendNumber(negative, magnitude, 0, 0, width, pad);
+}
+
+Formatter& Formatter::appendUnsigned(uint32_t value, int width, char pad) {
+    return appendNumber(false, value, 0, 0, width, pad);
+}
+
+Formatter& Formatter::appendFixed(int32_t value, int frac_bits, int decimals, int width, char pad) {
+    if (decimals < 0) decimals = 0;
+    if (decimals > MAX_DECIMALS) decimals = MAX_DECIMALS;
+    if (frac_bits < 0) frac_bits = 0;
+    if (frac_bits > 31) frac_bits = 31;
+
+    bool negative = (value < 0);
+    uint64_t magnitude = negative ? 0u - (uint32_t) value : (uint32_t) value;
+
+    // scale to decimal places and round half up, all in integer arithmetic
+    uint64_t scaled = ((magnitude * POWERS_OF_TEN[decimals] << 1) + ((uint64_t) 1 << frac_bits)) >> (frac_bits + 1);
+    auto integer = (uint32_t) (scaled / POWERS_OF_TEN[decimals]);
+    auto fraction = (uint32_t) (scaled % POWERS_OF_TEN[decimals]);
+
+    return appendNumber(negative && scaled > 0, integer, fraction, decimals, width, pad);
+}
+
+Formatter& Formatter::appendNumber(bool negative, uint32_t integer, uint32_t fraction, int decimals, int width, char pad) {
+
+    // digits are produced backwards into a scratch buffer
+    char digits[24];
+    int count = 0;
+
+    for (int i = 0; i < decimals; i++) {
+        digits[count++] = (char) ('0' + fraction % 10);
+        fraction /= 10;
+    }
+    if (decimals > 0) digits[count++] = '.';
+
+    do {
+        digits[count++] = (char) ('0' + integer % 10);
+        integer /= 10;
+    } while (integer > 0);
+
+    int padding = width - count - (negative ? 1 : 0);
+
+    if ('0' == pad) {
+        if (negative) append('-');
+        for (; padding > 0; padding--) append('0');
+    } else {
+        for (; padding > 0; padding--) append(pad);
+        if (negative) append('-');
+    }
+
+    while (count > 0) {
+        append(digits[--count]);
+    }
+
+    return *this;
+}
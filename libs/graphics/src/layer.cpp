@@ -0,0 +1,309 @@
+//
+// Layer
+//
+#include "graphics/layer.h"
+#include "graphics/device.h"
+
+#include <memory.h>
+#include <algorithm>
+
+#include "sys/trace.h"
+
+using namespace graphics;
+
+// ############################################################################
+// Layer
+// ############################################################################
+
+Layer::Layer(int width, int height)
+    : width_(std::max(width, 0)),
+      height_(std::max(height, 0)),
+      num_pages_((height_ + 7) / 8) {
+    buffer_.resize(num_pages_ * width_, 0x0);
+    markAll();
+}
+
+int Layer::width() const {
+    return width_;
+}
+
+int Layer::height() const {
+    return height_;
+}
+
+uint8_t* Layer::buffer() {
+    return buffer_.data();
+}
+
+const uint8_t* Layer::buffer() const {
+    return buffer_.data();
+}
+
+size_t Layer::bufferSize() const {
+    return buffer_.size();
+}
+
+void Layer::clear() {
+    memset(buffer_.data(), 0, buffer_.size());
+    markAll();
+}
+
+void Layer::setPosition(int x, int y) {
+    if (x == x_ && y == y_) return;
+
+    markAll();  // old area
+    x_ = x;
+    y_ = y;
+    markAll();  // new area
+}
+
+int Layer::x() const {
+    return x_;
+}
+
+int Layer::y() const {
+    return y_;
+}
+
+void Layer::setVisible(bool visible) {
+    if (visible == visible_) return;
+    visible_ = visible;
+    markAll();
+}
+
+bool Layer::isVisible() const {
+    return visible_;
+}
+
+void Layer::setBlendMode(BlendMode mode) {
+    blend_mode_ = mode;
+    markAll();
+}
+
+BlendMode Layer::blendMode() const {
+    return blend_mode_;
+}
+
+void Layer::setMask(const Layer* mask) {
+    if (nullptr != mask && (mask->width_ != width_ || mask->height_ != height_)) {
+        mask = nullptr;  // size mismatch
+    }
+
+    mask_ = mask;
+    markAll();
+}
+
+const Layer* Layer::mask() const {
+    return mask_;
+}
+
+void Layer::markRegion(int x, int y) {
+    markRegion(x, x, y, y);
+}
+
+void Layer::markRegion(int x_start, int x_end, int y) {
+    markRegion(x_start, x_end, y, y);
+}
+
+void Layer::markRegion(int x_start, int x_end, int y_start, int y_end) {
+    if (x_start > x_end) std::swap(x_start, x_end);
+    if (y_start > y_end) std::swap(y_start, y_end);
+
+    x_start = std::max(x_start, 0);
+    x_end = std::min(x_end, width_ - 1);
+    y_start = std::max(y_start, 0);
+    y_end = std::min(y_end, height_ - 1);
+
+    if (x_start > x_end || y_start > y_end) return;
+
+    markScreenRegion(x_ + x_start, x_ + x_end, y_ + y_start, y_ + y_end);
+}
+
+void Layer::markRegion(const Rectangle& region) {
+    markRegion(region.left, region.right, region.top, region.bottom);
+}
+
+void Layer::markAll() {
+    if (0 == width_ || 0 == height_) return;
+    markScreenRegion(x_, x_ + width_ - 1, y_, y_ + height_ - 1);
+}
+
+void Layer::markScreenRegion(int x_start, int x_end, int y_start, int y_end) {
+    if (!dirty_) {
+        dirty_region_.set(x_start, x_end, y_start, y_end);
+        dirty_ = true;
+    } else {
+        dirty_region_.join(x_start, x_end, y_start, y_end);
+    }
+}
+
+const Rectangle& Layer::dirtyRegion() const {
+    return dirty_region_;
+}
+
+bool Layer::isDirty() const {
+    return dirty_;
+}
+
+void Layer::clearDirty() {
+    dirty_ = false;
+}
+
+uint8_t Layer::fetch(int x, int y) const {
+    // 8 vertical pixels starting at layer row y, rows outside the layer are off
+    int page = floorDiv(y, 8);
+    int shift = y & 7;
+
+    uint16_t lo = (page >= 0 && page < num_pages_) ? buffer_[page * width_ + x] : 0x0;
+    uint16_t hi = (page + 1 >= 0 && page + 1 < num_pages_) ? buffer_[(page + 1) * width_ + x] : 0x0;
+
+    return (uint8_t) (((hi << 8) | lo) >> shift);
+}
+
+// ############################################################################
+// Compositor
+// ############################################################################
+
+Compositor::Compositor() {}
+
+bool Compositor::addLayer(Layer* layer) {
+    if (nullptr == layer || num_layers_ >= MAX_LAYERS) {
+        return false;
+    }
+
+    layers_[num_layers_++] = layer;
+    layer->markAll();
+
+    return true;
+}
+
+bool Compositor::removeLayer(Layer* layer) {
+    for (size_t i = 0; i < num_layers_; i++) {
+        if (layers_[i] == layer) {
+            for (size_t j = i + 1; j < num_layers_; j++) {
+                layers_[j - 1] = layers_[j];
+            }
+            num_layers_--;
+            invalid_ = true;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+size_t Compositor::numLayers() const {
+    return num_layers_;
+}
+
+void Compositor::invalidate() {
+    invalid_ = true;
+}
+
+bool Compositor::compose(Device* device) {
+    TRACE_SCOPE("compositor.compose");
+
+    if (nullptr == device || nullptr == device->buffer()) {
+        return false;
+    }
+
+    int width = device->width();
+    int num_pages = device->height() / 8;
+
+    if (line_.size() < (size_t) width) {
+        line_.resize(width);
+    }
+
+    bool composed = false;
+
+    for (int page = 0; page < num_pages; page++) {
+        int page_top = page * 8;
+        int page_bottom = page_top + 7;
+
+        int x_start = width;
+        int x_end = -1;
+
+        if (invalid_) {
+            x_start = 0;
+            x_end = width - 1;
+        } else {
+            for (size_t i = 0; i < num_layers_; i++) {
+                auto layer = layers_[i];
+                if (!layer->dirty_) continue;
+
+                const auto& region = layer->dirty_region_;
+                if (region.bottom < page_top || region.top > page_bottom) continue;
+
+                x_start = std::min(x_start, region.left);
+                x_end = std::max(x_end, region.right);
+            }
+
+            x_start = std::max(x_start, 0);
+            x_end = std::min(x_end, width - 1);
+        }
+
+        if (x_start > x_end) continue;
+
+        composePage(device, page, x_start, x_end);
+        composed = true;
+    }
+
+    for (size_t i = 0; i < num_layers_; i++) {
+        layers_[i]->clearDirty();
+    }
+
+    invalid_ = false;
+
+    return composed;
+}
+
+void Compositor::composePage(Device* device, int page, int x_start, int x_end) {
+    int page_top = page * 8;
+    auto line = line_.data();
+
+    memset(line + x_start, 0, x_end - x_start + 1);
+
+    for (size_t i = 0; i < num_layers_; i++) {
+        auto layer = layers_[i];
+        if (!layer->visible_) continue;
+
+        // rows of this page covered by the layer
+        int y = page_top - layer->y_;
+        int row_start = std::max(0, -y);
+        int row_end = std::min(8, layer->height_ - y);
+        if (row_start >= row_end) continue;
+
+        uint8_t rows = (uint8_t) (((1 << row_end) - 1) & ~((1 << row_start) - 1));
+
+        int col_start = std::max(x_start, layer->x_);
+        int col_end = std::min(x_end, layer->x_ + layer->width_ - 1);
+
+        auto mask_layer = layer->mask_;
+        auto mode = layer->blend_mode_;
+
+        for (int col = col_start; col <= col_end; col++) {
+            int x = col - layer->x_;
+            uint8_t src = layer->fetch(x, y);
+            uint8_t mask = (nullptr != mask_layer) ? (rows & mask_layer->fetch(x, y)) : rows;
+            uint8_t& dest = line[col];
+
+            switch (mode) {
+                case BlendMode::Opaque:
+                    dest = (dest & ~mask) | (src & mask);
+                    break;
+                case BlendMode::Or:
+                    dest |= (src & mask);
+                    break;
+                case BlendMode::And:
+                    dest &= (src | ~mask);
+                    break;
+                case BlendMode::Xor:
+                    dest ^= (src & mask);
+                    break;
+            }
+        }
+    }
+
+    memcpy(device->buffer() + page * device->width() + x_start, line + x_start, x_end - x_start + 1);
+    device->markRegion(x_start, x_end, page_top);
+}
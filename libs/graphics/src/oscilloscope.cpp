@@ -13,34 +13,635 @@
 
 using namespace graphics;
 
-void Oscilloscope::init() {
-    ESP_LOGI("oscilloscope", "Oscilloscope initialized");
-    buffer_size_ = 128;
+#define TAG "oscilloscope"
+
+void Oscilloscope::init(size_t columns) {
+    ESP_LOGI(TAG, "Oscilloscope initialized");
+    buffer_size_ = std::max((size_t) 1, columns);
+    applyPreTrigger();
     clear();
 }
 
 void Oscilloscope::clear() {
-    buffer_.resize(buffer_size_, 0);
-    buffer_ofs_ = buffer_read_ofs_ = buffer_usage_ = 0;
-    min_value_ = max_value_ = value_ = 0;
+    buffer_.assign(buffer_size_ * num_channels_, Column{0, 0, 0});
+    buffer_ofs_ = buffer_usage_ = 0;
+    columns_total_ = sweep_drawn_ = 0;
+    sweep_valid_ = false;
+    bucket_count_ = 0;
+
+    acquisition_.assign(buffer_size_ * num_channels_, Column{0, 0, 0});
+    capture_.assign(buffer_size_ * num_channels_, Column{0, 0, 0});
+    acquisition_columns_ = capture_columns_ = 0;
+    acquisition_bucket_count_ = 0;
+    capturing_ = new_capture_ = trigger_armed_ = false;
+    since_trigger_ = 0;
+    history_.assign(pre_trigger_ * num_channels_, 0);
+    history_ofs_ = history_usage_ = 0;
+    resetDeep();
+
+    samples_.assign(Spectrum::MAX_POINTS, 0);
+    samples_ofs_ = samples_usage_ = samples_new_ = 0;
+    spectrum_.reset();
+
+    for (auto& channel : channels_) {
+        channel.value = 0;
+    }
+
+    min_value_ = max_value_ = 0;
     first_value_ = true;
+    resetEnvelope();
 }
 
-void Oscilloscope::add(int value) {
-    value_ = value;
+// ############################################################################
+// Acquisition
+// ############################################################################
+
+void Oscilloscope::scaleFrame(const int* raw, int* frame) const {
+    for (size_t c = 0; c < num_channels_; c++) {
+        const auto& channel = channels_[c];
+        // unity gain passes any int unchanged, otherwise widen to avoid overflow
+        int value = (256 == channel.gain) ? raw[c] : (int) (((int64_t) raw[c] * channel.gain) >> 8);
+        frame[c] = value + channel.offset;
+    }
+}
+
+void Oscilloscope::addFrame(const int* frame, const int* raw) {
+    for (size_t c = 0; c < num_channels_; c++) {
+        int value = frame[c];
+        if (first_value_ || value < min_value_) min_value_ = value;
+        if (first_value_ || value > max_value_) max_value_ = value;
+        first_value_ = false;
+    }
+
+    if (ScopeView::Spectrum == view_) {
+        samples_[samples_ofs_] = raw[source_channel_];
+        samples_ofs_ = (samples_ofs_ + 1) % samples_.size();
+        if (samples_usage_ < samples_.size()) samples_usage_++;
+        samples_new_++;
+    }
+
+    if (isDeepMemory()) {
+        addDeep(frame, raw);
+        return;
+    }
+
+    if (TriggerEdge::None != trigger_edge_) {
+        addTriggered(frame, raw);
+        return;
+    }
 
-    if (first_value_ || value < min_value_) min_value_ = value;
-    if (first_value_ || value > max_value_) max_value_ = value;
-    first_value_ = false;
+    for (size_t c = 0; c < num_channels_; c++) {
+        int value = frame[c];
+        auto& bucket = bucket_[c];
+        if (0 == bucket_count_) {
+            bucket = Column{value, value, value};
+        } else {
+            if (value < bucket.min) bucket.min = value;
+            if (value > bucket.max) bucket.max = value;
+            bucket.last = value;
+        }
+    }
 
-    buffer_[buffer_ofs_] = value;
-    buffer_read_ofs_ = buffer_ofs_;
+    if (++bucket_count_ >= samples_per_column_) {
+        pushColumn();
+    }
+}
+
+void Oscilloscope::pushColumn() {
+    std::copy(bucket_, bucket_ + num_channels_, &buffer_[buffer_ofs_ * num_channels_]);
     buffer_ofs_ = (buffer_ofs_ + 1) % buffer_size_;
 
     if (buffer_usage_ < buffer_size_) buffer_usage_++;
+    columns_total_++;
+
+    bucket_count_ = 0;
+}
+
+void Oscilloscope::add(int value) {
+    int raw[MAX_CHANNELS];
+    int frame[MAX_CHANNELS];
+
+    channels_[0].value = value;
+    for (size_t c = 0; c < num_channels_; c++) {
+        raw[c] = channels_[c].value;
+    }
+
+    scaleFrame(raw, frame);
+    addFrame(frame, raw);
+}
+
+void Oscilloscope::add(const uint16_t* values, size_t count) {
+    if (nullptr == values || count < num_channels_) return;
+
+    int raw[MAX_CHANNELS];
+    int frame[MAX_CHANNELS];
+
+    for (size_t i = 0; i + num_channels_ <= count; i += num_channels_) {
+        for (size_t c = 0; c < num_channels_; c++) {
+            raw[c] = values[i + c];
+        }
+        scaleFrame(raw, frame);
+        addFrame(frame, raw);
+    }
+
+    auto last = values + (count / num_channels_ - 1) * num_channels_;
+    for (size_t c = 0; c < num_channels_; c++) {
+        channels_[c].value = last[c];
+    }
+}
+
+int Oscilloscope::getValue(size_t channel) const {
+    return (channel < num_channels_) ? channels_[channel].value : 0;
+}
+
+// ############################################################################
+// Channels
+// ############################################################################
+
+void Oscilloscope::setChannels(size_t count) {
+    num_channels_ = std::min(std::max((size_t) 1, count), MAX_CHANNELS);
+    if (source_channel_ >= num_channels_) source_channel_ = 0;
+    clear();
+}
+
+size_t Oscilloscope::getChannels() const {
+    return num_channels_;
+}
+
+void Oscilloscope::setChannelScale(size_t channel, float gain, int offset) {
+    if (channel >= MAX_CHANNELS) return;
+    channels_[channel].gain = (int32_t) lroundf(gain * 256.0f);
+    channels_[channel].offset = offset;
+    sweep_valid_ = false;
+}
+
+void Oscilloscope::setChannelStyle(size_t channel, TraceStyle style) {
+    if (channel >= MAX_CHANNELS) return;
+    channels_[channel].style = style;
+    sweep_valid_ = false;
+}
+
+void Oscilloscope::setSourceChannel(size_t channel) {
+    if (channel >= num_channels_) return;
+    source_channel_ = channel;
+    trigger_armed_ = false;
+    capturing_ = false;
+    samples_usage_ = samples_new_ = 0;
+    spectrum_.reset();
+}
+
+size_t Oscilloscope::getSourceChannel() const {
+    return source_channel_;
+}
+
+// ############################################################################
+// Trigger
+// ############################################################################
+
+size_t Oscilloscope::captureLength() const {
+    return buffer_size_ * samples_per_column_;
+}
+
+void Oscilloscope::updateTrigger(int value) {
+    if (since_trigger_ < SIZE_MAX) since_trigger_++;
+
+    // the signal has to leave the level by the hysteresis before an edge counts
+    if (TriggerEdge::Rising == trigger_edge_) {
+        if (value <= trigger_level_ - trigger_hysteresis_) trigger_armed_ = true;
+    } else {
+        if (value >= trigger_level_ + trigger_hysteresis_) trigger_armed_ = true;
+    }
+}
+
+bool Oscilloscope::isTriggerEdge(int value) const {
+    if (!trigger_armed_ || since_trigger_ < holdoff_ || history_usage_ < pre_trigger_) {
+        return false;
+    }
+
+    return (TriggerEdge::Rising == trigger_edge_) ? (value >= trigger_level_) : (value <= trigger_level_);
+}
+
+void Oscilloscope::pushHistory(const int* raw) {
+    if (history_.empty()) return;
+
+    std::copy(raw, raw + num_channels_, &history_[history_ofs_ * num_channels_]);
+    history_ofs_ = (history_ofs_ + 1) % pre_trigger_;
+    if (history_usage_ < pre_trigger_) history_usage_++;
+}
+
+void Oscilloscope::addTriggered(const int* frame, const int* raw) {
+    int value = frame[source_channel_];
+    updateTrigger(value);
+
+    if (capturing_) {
+        captureFrame(frame);
+        if (0 == --capture_remaining_) completeCapture();
+    } else if (isTriggerEdge(value)) {
+        startCapture(frame);
+    }
+
+    pushHistory(raw);
+}
+
+void Oscilloscope::startCapture(const int* frame) {
+    trigger_armed_ = false;
+    since_trigger_ = 0;
+    capturing_ = true;
+    acquisition_columns_ = 0;
+    acquisition_bucket_count_ = 0;
+
+    // pre-trigger frames, oldest first (the history is full at this point)
+    int history_frame[MAX_CHANNELS];
+    for (size_t i = 0; i < pre_trigger_; i++) {
+        scaleFrame(&history_[((history_ofs_ + i) % pre_trigger_) * num_channels_], history_frame);
+        captureFrame(history_frame);
+    }
+
+    captureFrame(frame);
+
+    capture_remaining_ = captureLength() - pre_trigger_ - 1;
+    if (0 == capture_remaining_) completeCapture();
+}
+
+void Oscilloscope::captureFrame(const int* frame) {
+    for (size_t c = 0; c < num_channels_; c++) {
+        int value = frame[c];
+        auto& bucket = acquisition_bucket_[c];
+        if (0 == acquisition_bucket_count_) {
+            bucket = Column{value, value, value};
+        } else {
+            if (value < bucket.min) bucket.min = value;
+            if (value > bucket.max) bucket.max = value;
+            bucket.last = value;
+        }
+    }
+
+    if (++acquisition_bucket_count_ >= samples_per_column_ && acquisition_columns_ < buffer_size_) {
+        std::copy(acquisition_bucket_, acquisition_bucket_ + num_channels_,
+                  &acquisition_[acquisition_columns_ * num_channels_]);
+        acquisition_columns_++;
+        acquisition_bucket_count_ = 0;
+    }
+}
+
+void Oscilloscope::completeCapture() {
+    capturing_ = false;
+
+    // swap acquisition and display buffers
+    std::swap(acquisition_, capture_);
+    capture_columns_ = acquisition_columns_;
+
+    new_capture_ = true;
+    trigger_count_++;
+}
+
+void Oscilloscope::setTrigger(TriggerEdge edge, int level, int hysteresis) {
+    trigger_edge_ = edge;
+    trigger_level_ = level;
+    trigger_hysteresis_ = std::max(0, hysteresis);
+    trigger_armed_ = false;
+    capturing_ = false;
+    sweep_valid_ = false;
+}
+
+TriggerEdge Oscilloscope::getTriggerEdge() const {
+    return trigger_edge_;
+}
+
+void Oscilloscope::setHoldoff(size_t samples) {
+    holdoff_ = samples;
+}
+
+void Oscilloscope::setPreTrigger(size_t samples) {
+    pre_trigger_request_ = samples;
+    applyPreTrigger();
+}
+
+void Oscilloscope::applyPreTrigger() {
+    // at least the trigger frame itself belongs to the capture
+    size_t length = captureLength();
+    pre_trigger_ = std::min(pre_trigger_request_, (length > 0) ? length - 1 : 0);
+    history_.assign(pre_trigger_ * num_channels_, 0);
+    history_ofs_ = history_usage_ = 0;
+    capturing_ = false;
+}
+
+bool Oscilloscope::takeNewCapture() {
+    bool result = new_capture_;
+    new_capture_ = false;
+    return result;
+}
+
+uint32_t Oscilloscope::getTriggerCount() const {
+    return trigger_count_;
+}
+
+// ############################################################################
+// Settings
+// ############################################################################
+
+void Oscilloscope::setSamplesPerColumn(size_t count) {
+    samples_per_column_ = std::max((size_t) 1, count);
+    bucket_count_ = 0;
+    capturing_ = false;
+    sweep_valid_ = false;
+    applyPreTrigger();
+}
+
+size_t Oscilloscope::getSamplesPerColumn() const {
+    return samples_per_column_;
+}
+
+void Oscilloscope::setTraceMode(TraceMode mode) {
+    trace_mode_ = mode;
+}
+
+TraceMode Oscilloscope::getTraceMode() const {
+    return trace_mode_;
+}
+
+void Oscilloscope::setEnvelope(bool enable, int decay) {
+    envelope_ = enable;
+    envelope_decay_ = std::max(0, decay);
+    resetEnvelope();
+}
+
+void Oscilloscope::resetEnvelope() {
+    envelope_top_.clear();
+    envelope_bottom_.clear();
+}
+
+void Oscilloscope::setRollMode(RollMode mode) {
+    roll_mode_ = mode;
+    sweep_valid_ = false;
+}
+
+RollMode Oscilloscope::getRollMode() const {
+    return roll_mode_;
+}
+
+bool Oscilloscope::isIncremental() const {
+    return RollMode::Sweep == roll_mode_ && TriggerEdge::None == trigger_edge_ &&
+           ScopeView::Time == view_ && !isDeepMemory();
+}
+
+void Oscilloscope::invalidate() {
+    sweep_valid_ = false;
+}
+
+// ############################################################################
+// Deep Memory
+// ############################################################################
+
+bool Oscilloscope::setDeepMemory(size_t capacity, sys::SampleFormat format, sys::MemorySource source) {
+    deep_.release();
+
+    bool result = true;
+    if (capacity > 0) {
+        result = deep_.allocate(capacity * num_channels_, format, source);
+        if (result) {
+            ESP_LOGI(TAG, "deep memory: %u frames, %u bytes", (unsigned) capacity, (unsigned) deep_.bytes());
+        }
+    }
+
+    clear();
+    return result;
+}
+
+bool Oscilloscope::setDeepMemory(void* arena, size_t size, sys::SampleFormat format) {
+    bool result = deep_.attach(arena, size, format);
+    clear();
+    return result;
+}
+
+bool Oscilloscope::isDeepMemory() const {
+    return deep_.capacity() > 0;
+}
+
+size_t Oscilloscope::deepCapacity() const {
+    return deep_.capacity() / num_channels_;
+}
+
+void Oscilloscope::resetDeep() {
+    deep_length_ = 0;
+    deep_armed_ = deep_recording_ = deep_complete_ = false;
+    mip_levels_ = 0;
+
+    auto capacity = deepCapacity();
+    if (0 == capacity) {
+        mipmap_.clear();
+        return;
+    }
+
+    // level sizes: one entry per MIP_BLOCK frames, then MIP_FANOUT entries per entry
+
+    size_t entries = 0;
+    size_t count = (capacity + MIP_BLOCK - 1) / MIP_BLOCK;
+    while (mip_levels_ < MAX_MIP_LEVELS) {
+        mip_offsets_[mip_levels_++] = entries;
+        entries += count;
+        if (count <= 1) break;
+        count = (count + MIP_FANOUT - 1) / MIP_FANOUT;
+    }
+
+    mipmap_.assign(entries * num_channels_, Range{0, 0});
+}
+
+void Oscilloscope::arm() {
+    deep_armed_ = true;
+    deep_recording_ = false;
+    trigger_armed_ = false;
+}
+
+size_t Oscilloscope::getDeepLength() const {
+    return deep_complete_ ? deep_length_ : 0;
+}
+
+void Oscilloscope::setDeepView(size_t first, size_t frames_per_column) {
+    deep_first_ = first;
+    deep_zoom_ = std::max((size_t) 1, frames_per_column);
+}
+
+size_t Oscilloscope::getDeepPosition() const {
+    return deep_first_;
+}
+
+size_t Oscilloscope::getDeepZoom() const {
+    return deep_zoom_;
+}
+
+void Oscilloscope::addDeep(const int* frame, const int* raw) {
+    bool triggered = (TriggerEdge::None != trigger_edge_);
+    int value = frame[source_channel_];
+
+    if (triggered) {
+        updateTrigger(value);
+    }
+
+    if (deep_recording_) {
+        recordDeep(raw);
+    } else if (deep_armed_ && (!triggered || isTriggerEdge(value))) {
+        startDeep(raw);
+    }
+
+    pushHistory(raw);
+}
+
+void Oscilloscope::startDeep(const int* raw) {
+    deep_armed_ = false;
+    deep_recording_ = true;
+    deep_complete_ = false;
+    deep_length_ = 0;
+
+    if (TriggerEdge::None != trigger_edge_) {
+        trigger_armed_ = false;
+        since_trigger_ = 0;
+
+        // pre-trigger frames, oldest first
+        for (size_t i = 0; i < pre_trigger_ && deep_recording_; i++) {
+            recordDeep(&history_[((history_ofs_ + i) % pre_trigger_) * num_channels_]);
+        }
+    }
+
+    if (deep_recording_) {
+        recordDeep(raw);
+    }
+}
+
+void Oscilloscope::recordDeep(const int* raw) {
+    auto index = deep_length_;
+    auto entry = &mipmap_[(index / MIP_BLOCK) * num_channels_];
+
+    for (size_t c = 0; c < num_channels_; c++) {
+        // narrowed to the 12 bit storage here only
+        auto value = (uint16_t) std::min(std::max(raw[c], 0), 4095);
+        deep_.set(index * num_channels_ + c, value);
+
+        // the first mipmap level is kept up to date while recording
+        auto& range = entry[c];
+        if (0 == index % MIP_BLOCK) {
+            range = Range{value, value};
+        } else {
+            if (value < range.min) range.min = value;
+            if (value > range.max) range.max = value;
+        }
+    }
+
+    if (++deep_length_ >= deepCapacity()) {
+        completeDeep();
+    }
+}
+
+void Oscilloscope::completeDeep() {
+    deep_recording_ = false;
+
+    // merge the upper mipmap levels once per capture
+
+    size_t count = (deep_length_ + MIP_BLOCK - 1) / MIP_BLOCK;
+    for (size_t level = 1; level < mip_levels_; level++) {
+        auto src = &mipmap_[mip_offsets_[level - 1] * num_channels_];
+        auto dest = &mipmap_[mip_offsets_[level] * num_channels_];
+        size_t dest_count = (count + MIP_FANOUT - 1) / MIP_FANOUT;
+
+        for (size_t i = 0; i < dest_count; i++) {
+            for (size_t c = 0; c < num_channels_; c++) {
+                auto range = src[i * MIP_FANOUT * num_channels_ + c];
+                for (size_t j = i * MIP_FANOUT + 1; j < std::min(count, (i + 1) * MIP_FANOUT); j++) {
+                    const auto& child = src[j * num_channels_ + c];
+                    range.min = std::min(range.min, child.min);
+                    range.max = std::max(range.max, child.max);
+                }
+                dest[i * num_channels_ + c] = range;
+            }
+        }
+
+        count = dest_count;
+    }
+
+    deep_complete_ = true;
+    new_capture_ = true;
+    trigger_count_++;
+}
+
+Oscilloscope::Column Oscilloscope::deepColumn(size_t first, size_t last, size_t channel) const {
+    uint16_t lo = deep_.get(first * num_channels_ + channel);
+    uint16_t hi = lo;
+
+    // walk the column with the coarsest mipmap entries that lie completely
+    // inside it, the unaligned edges are read from the samples. Per column this
+    // reads less than 2 * MIP_BLOCK samples and 2 * MIP_FANOUT entries per
+    // level, and no neighbouring frame leaks into the peak detection.
+
+    size_t i = first;
+    while (i < last) {
+        if (0 != i % MIP_BLOCK || i + MIP_BLOCK > last) {
+            auto value = deep_.get(i * num_channels_ + channel);
+            lo = std::min(lo, value);
+            hi = std::max(hi, value);
+            i++;
+            continue;
+        }
+
+        size_t level = 0;
+        size_t block = MIP_BLOCK;
+        while (level + 1 < mip_levels_ && 0 == i % (block * MIP_FANOUT) && i + block * MIP_FANOUT <= last) {
+            level++;
+            block *= MIP_FANOUT;
+        }
+
+        const auto& range = mipmap_[(mip_offsets_[level] + i / block) * num_channels_ + channel];
+        lo = std::min(lo, range.min);
+        hi = std::max(hi, range.max);
+        i += block;
+    }
+
+    const auto& ch = channels_[channel];
+    int min = ((lo * ch.gain) >> 8) + ch.offset;
+    int max = ((hi * ch.gain) >> 8) + ch.offset;
+    int last_value = ((deep_.get((last - 1) * num_channels_ + channel) * ch.gain) >> 8) + ch.offset;
+    if (min > max) std::swap(min, max);
+
+    return Column{min, max, last_value};
+}
+
+// ############################################################################
+// Spectrum
+// ############################################################################
+
+void Oscilloscope::setView(ScopeView view) {
+    view_ = view;
+    sweep_valid_ = false;
+    samples_usage_ = samples_new_ = 0;
+    spectrum_.reset();
 }
 
-int Oscilloscope::getValue() const { return value_; }
+ScopeView Oscilloscope::getView() const {
+    return view_;
+}
+
+Spectrum& Oscilloscope::spectrum() {
+    return spectrum_;
+}
+
+bool Oscilloscope::process() {
+    if (ScopeView::Spectrum != view_) {
+        return false;
+    }
+
+    // transform the newest samples once enough new ones came in
+
+    auto points = (size_t) spectrum_.getPoints();
+    if (!spectrum_.isBusy() && samples_usage_ >= points && samples_new_ >= points) {
+        spectrum_.start(samples_.data(), samples_.size(), samples_ofs_);
+        samples_new_ = 0;
+    }
+
+    return spectrum_.process();
+}
+
+// ############################################################################
+// Rendering
+// ############################################################################
 
 void Oscilloscope::draw(graphics::Display* display) {
     draw(display, 0, 0, display->width()-1, display->height()-1, true, 0, 0);
@@ -51,8 +652,24 @@ void Oscilloscope::draw(graphics::Display* display,
                         bool show_text, int text_pos_x, int text_pos_y) {
 
     if (show_text) {
-        sprintf(textbuffer_, "DATA: %d", value_);
-        display->drawString(text_pos_x, text_pos_y, textbuffer_);
+        TextBuffer<16> text;
+        text.append("DATA: ").appendInt(channels_[0].value);
+        display->drawString(text_pos_x, text_pos_y, text.c_str(), text.length());
+    }
+
+    if (ScopeView::Spectrum == view_) {
+        spectrum_.draw(display, x1, y1, x2, y2);
+        return;
+    }
+
+    if (isIncremental()) {
+        drawSweep(display, x1, y1, x2, y2);
+        return;
+    }
+
+    if (isDeepMemory()) {
+        drawDeep(display, x1, y1, x2, y2);
+        return;
     }
 
     int w = 1 + ((x2 >= x1) ? x2 - x1 : x1 - x2);
@@ -60,45 +677,222 @@ void Oscilloscope::draw(graphics::Display* display,
 
     int height = (h > 0) ? h : display->height();
     int width = (w > 0) ? w : display->width();
-    if (width > buffer_size_) width = buffer_size_;
+    if (width > (int) buffer_size_) width = buffer_size_;
+
+    int center = 0;
+    if (center < min_value_) center = min_value_;
+    if (center > max_value_) center = max_value_;
+
+    display->drawHorizontalLine(x1, toScreen(center, y1, height), x2);
+
+    auto envelope_size = (size_t) width * num_channels_;
+    if (envelope_ && envelope_top_.size() != envelope_size) {
+        envelope_top_.assign(envelope_size, y1 + height);
+        envelope_bottom_.assign(envelope_size, y1 - 1);
+    }
+
+    if (TriggerEdge::None != trigger_edge_) {
+        int level_y = toScreen(trigger_level_, y1, height);
+        display->drawHorizontalLine(x1, level_y, x1 + 2);
+        display->drawVerticalLine(x1 + (int) (pre_trigger_ / samples_per_column_), y1, y1 + 2);
+    }
+
+    for (size_t c = 0; c < num_channels_; c++) {
+        auto style = channels_[c].style;
 
+        for (int i = 0; i < width; i++) {
+            auto columns = screenColumns(i, width);
+            if (nullptr == columns) continue;
+
+            auto previous = (i > 0) ? screenColumns(i - 1, width) : nullptr;
+
+            int top, bottom;
+            drawColumn(display, x1 + i, y1, height, columns[c],
+                       (nullptr != previous) ? &previous[c] : nullptr, style, top, bottom);
+
+            if (envelope_) {
+                auto& env_top = envelope_top_[i * num_channels_ + c];
+                auto& env_bottom = envelope_bottom_[i * num_channels_ + c];
+                if (envelope_decay_ > 0) {
+                    env_top += envelope_decay_;
+                    env_bottom -= envelope_decay_;
+                }
+                env_top = std::min(env_top, top);
+                env_bottom = std::max(env_bottom, bottom);
+                display->drawPixel(x1 + i, env_top);
+                display->drawPixel(x1 + i, env_bottom);
+            }
+        }
+    }
+}
+
+const Oscilloscope::Column* Oscilloscope::screenColumns(int x, int width) const {
+
+    // a capture starts at the left, roll mode shows the newest columns at the right
+
+    if (TriggerEdge::None != trigger_edge_) {
+        return ((size_t) x < capture_columns_) ? &capture_[x * num_channels_] : nullptr;
+    }
+
+    size_t age = (size_t) (width - 1 - x);         // 0 is the newest column
+    if (age >= buffer_usage_) return nullptr;
+
+    return &buffer_[((columns_total_ - 1 - age) % buffer_size_) * num_channels_];
+}
+
+int Oscilloscope::toScreen(int value, int y1, int height) const {
     int range = max_value_ - min_value_;
+    return y1 + ((range > 0) ? height - 1 - ((value - min_value_) * (height - 1) / range) : 0);
+}
+
+void Oscilloscope::drawColumn(graphics::Display* display, int x, int y1, int height,
+                              const Column& column, const Column* previous, TraceStyle style,
+                              int& top, int& bottom) const {
+
+    // each column only touches itself, the connection to the previous
+    // column is drawn as a vertical span
+
+    int span_top, span_bottom;
+
+    if (TraceMode::PeakDetect == trace_mode_) {
+        top = toScreen(column.max, y1, height);
+        bottom = toScreen(column.min, y1, height);
+        span_top = top;
+        span_bottom = bottom;
+        if (nullptr != previous) {
+            span_bottom = std::max(span_bottom, toScreen(previous->max, y1, height));
+            span_top = std::min(span_top, toScreen(previous->min, y1, height));
+        }
+    } else {
+        top = bottom = toScreen(column.last, y1, height);
+        span_top = span_bottom = top;
+        if (nullptr != previous) {
+            int y = toScreen(previous->last, y1, height);
+            span_top = std::min(span_top, y);
+            span_bottom = std::max(span_bottom, y);
+        }
+    }
+
+    switch (style) {
+        case TraceStyle::Dotted:
+            for (int y = span_top + ((x + span_top) & 1); y <= span_bottom; y += 2) {
+                display->drawPixel(x, y);
+            }
+            break;
+        case TraceStyle::Xor: {
+            auto old_foreground = display->setForeground(graphics::INVERT);
+            display->drawVerticalLine(x, span_top, span_bottom);
+            display->setForeground(old_foreground);
+            break;
+        }
+        default:
+            display->drawVerticalLine(x, span_top, span_bottom);
+            break;
+    }
+}
+
+void Oscilloscope::drawSweep(graphics::Display* display, int x1, int y1, int x2, int y2) {
+    const int SWEEP_GAP = 3;    // blank columns ahead of the write position
+
+    int width = std::min(x2 - x1 + 1, (int) buffer_size_);
+    int height = y2 - y1 + 1;
+    if (width <= SWEEP_GAP || height <= 0) return;
+
+    // everything is redrawn when the scaling or the area changed or when
+    // more than one sweep came in since the last draw
+
+    bool redraw = !sweep_valid_ ||
+                  sweep_min_ != min_value_ || sweep_max_ != max_value_ ||
+                  sweep_area_[0] != x1 || sweep_area_[1] != y1 ||
+                  sweep_area_[2] != x2 || sweep_area_[3] != y2 ||
+                  columns_total_ - sweep_drawn_ > (size_t) width;
+
+    if (redraw) {
+        auto old_foreground = display->setForeground(graphics::BLACK);
+        display->fillRectangle(x1, y1, x2, y2);
+        display->setForeground(old_foreground);
+
+        sweep_drawn_ = columns_total_ - std::min(buffer_usage_, (size_t) width);
+        sweep_min_ = min_value_;
+        sweep_max_ = max_value_;
+        sweep_area_[0] = x1;
+        sweep_area_[1] = y1;
+        sweep_area_[2] = x2;
+        sweep_area_[3] = y2;
+        sweep_valid_ = true;
+    }
+
     int center = 0;
     if (center < min_value_) center = min_value_;
     if (center > max_value_) center = max_value_;
 
-    size_t ofs = buffer_read_ofs_;
-    size_t usage = buffer_usage_;
+    int center_y = toScreen(center, y1, height);
+    size_t first = columns_total_ - buffer_usage_;    // oldest column still buffered
 
-    int last_x = 0;
-    int last_y = 0;
-    int count = 0;
+    // drawing marks the touched columns dirty, nothing else is transferred
 
-    int i = width;
-    while (i > 0 && usage > 0) {
-        i--;
-        usage--;
+    for (size_t n = sweep_drawn_; n < columns_total_; n++) {
+        int x = x1 + (int) (n % width);
 
-        int v = buffer_[ofs];
-        if (ofs > 0) {
-            ofs--;
-        } else {
-            ofs = buffer_size_ - 1;
+        // erase the column and the gap ahead, restoring the center line
+
+        for (int i = 0; i <= SWEEP_GAP; i++) {
+            int gap_x = x1 + (int) ((n + i) % width);
+            auto old_foreground = display->setForeground(graphics::BLACK);
+            display->drawVerticalLine(gap_x, y1, y2);
+            display->setForeground(old_foreground);
+            display->drawPixel(gap_x, center_y);
         }
 
-        int y_center = y1 + ((range > 0) ? height - 1 - ((center - min_value_) * height / range) : 0);
-        display->drawHorizontalLine(x1, y_center, x2);
+        auto columns = &buffer_[(n % buffer_size_) * num_channels_];
+        auto previous = (n > first && x > x1) ? &buffer_[((n - 1) % buffer_size_) * num_channels_] : nullptr;
 
-        int x = x1 + i;
-        int y = y1 + ((range > 0) ? height - 1 - ((v - min_value_) * height / range) : 0);
+        for (size_t c = 0; c < num_channels_; c++) {
+            int top, bottom;
+            drawColumn(display, x, y1, height, columns[c],
+                       (nullptr != previous) ? &previous[c] : nullptr, channels_[c].style, top, bottom);
+        }
+    }
+
+    sweep_drawn_ = columns_total_;
+}
+
+void Oscilloscope::drawDeep(graphics::Display* display, int x1, int y1, int x2, int y2) {
+    int width = x2 - x1 + 1;
+    int height = y2 - y1 + 1;
+    if (width <= 0 || height <= 0) return;
+
+    int center = 0;
+    if (center < min_value_) center = min_value_;
+    if (center > max_value_) center = max_value_;
 
-        if (count > 0) {
-            display->drawLine(last_x, last_y, x, y);
+    display->drawHorizontalLine(x1, toScreen(center, y1, height), x2);
+
+    if (!deep_complete_ || 0 == deep_length_) return;
+
+    auto first = std::min(deep_first_, deep_length_ - 1);
+
+    if (TriggerEdge::None != trigger_edge_ && pre_trigger_ >= first) {
+        auto x = (pre_trigger_ - first) / deep_zoom_;
+        if (x < (size_t) width) {
+            display->drawVerticalLine(x1 + (int) x, y1, y1 + 2);
         }
+    }
 
-        last_x = x;
-        last_y = y;
+    for (size_t c = 0; c < num_channels_; c++) {
+        Column previous{0, 0, 0};
 
-        count++;
+        for (int i = 0; i < width; i++) {
+            size_t start = first + (size_t) i * deep_zoom_;
+            if (start >= deep_length_) break;
+
+            auto column = deepColumn(start, std::min(start + deep_zoom_, deep_length_), c);
+
+            int top, bottom;
+            drawColumn(display, x1 + i, y1, height, column, (i > 0) ? &previous : nullptr,
+                       channels_[c].style, top, bottom);
+
+            previous = column;
+        }
     }
 }
@@ -0,0 +1,104 @@
+//
+// Vertical Scroller
+//
+#include "graphics/scroller.h"
+#include "graphics/base.h"
+#include "graphics/device.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "sys/trace.h"
+
+using namespace graphics;
+
+VerticalScroller::VerticalScroller() {}
+
+// ############################################################################
+// Position
+// ############################################################################
+
+void VerticalScroller::setPosition(int y) {
+    position_ = y;
+}
+
+int VerticalScroller::position() const {
+    return position_;
+}
+
+void VerticalScroller::scroll(int pixels) {
+    position_ += pixels;
+}
+
+void VerticalScroller::invalidate() {
+    valid_ = false;
+}
+
+// ############################################################################
+// Rendering
+// ############################################################################
+
+void VerticalScroller::drawRows(Device* device, int y_start, int y_end) {
+
+    // content row y lives in ring row (y mod height), so content page k
+    // always maps to ring page (k mod pages). Pages at the top and bottom
+    // edge of the view share a ring page, masks keep the visible rows.
+
+    int width = std::min((int) device->width(), MAX_WIDTH);
+    int num_pages = device->height() / 8;
+    uint32_t touched = 0x0;
+
+    for (int index = floorDiv(y_start, 8); index <= floorDiv(y_end, 8); index++) {
+        auto first = std::max(y_start, index * 8);
+        auto last = std::min(y_end, index * 8 + 7);
+
+        uint8_t rows = 0x0;
+        for (int y = first; y <= last; y++) {
+            rows |= (uint8_t) (1 << (y - index * 8));
+        }
+
+        renderPage(page_buffer_, width, index);
+
+        auto page = floorMod(index, num_pages);
+        auto dest = device->buffer() + page * device->width();
+        auto keep = (uint8_t) ~rows;
+
+        for (int x = 0; x < width; x++) {
+            dest[x] = (dest[x] & keep) | (page_buffer_[x] & rows);
+        }
+
+        device->markRegion(0, width - 1, page * 8);
+        touched |= (1u << page);
+    }
+
+    // transfer before the start line moves the rows into view
+    for (int page = 0; page < num_pages; page++) {
+        if (0 != (touched & (1u << page))) {
+            device->refreshPage(page, false);
+        }
+    }
+}
+
+void VerticalScroller::update(Device* device) {
+    TRACE_SCOPE("scroller.update");
+
+    if (nullptr == device) return;
+
+    int height = device->height();
+    int delta = position_ - drawn_position_;
+
+    if (!valid_ || std::abs(delta) >= height) {
+        drawRows(device, position_, position_ + height - 1);
+    } else if (delta > 0) {
+        drawRows(device, drawn_position_ + height, position_ + height - 1);
+    } else if (delta < 0) {
+        drawRows(device, position_, drawn_position_ - 1);
+    }
+
+    if (!valid_ || 0 != delta) {
+        device->setVerticalOffset(floorMod(position_, height));
+    }
+
+    drawn_position_ = position_;
+    valid_ = true;
+}
@@ -0,0 +1,335 @@
+//
+// Spectrum
+//
+#include "graphics/spectrum.h"
+#include "graphics/display.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "esp_timer.h"
+#include "sys/trace.h"
+
+using namespace graphics;
+
+namespace {
+
+const int INPUT_SHIFT = 4;                  // 12 bit samples to Q15
+const int FULL_SCALE_DB10 = 843;            // power of a full scale sine bin: 10*log10(2^28)
+const size_t STEP_SIZE = 32;                // butterflies or bins between budget checks
+
+// log2(1 + i/32) in Q8
+const uint8_t LOG2_TABLE[32] = {
+    0, 11, 22, 33, 44, 54, 63, 73, 82, 92, 100, 109, 118, 126, 134, 142,
+    150, 157, 165, 172, 179, 186, 193, 200, 207, 213, 220, 226, 232, 238, 244, 250
+};
+
+inline int16_t mulQ15(int16_t a, int16_t b) {
+    return (int16_t) (((int32_t) a * b) >> 15);
+}
+
+}  // namespace
+
+Spectrum::Spectrum() {
+    computeTables();
+    reset();
+}
+
+// ############################################################################
+// Settings
+// ############################################################################
+
+bool Spectrum::setPoints(int points) {
+    if (128 != points && 256 != points && 512 != points) {
+        return false;
+    }
+
+    points_ = points;
+    log2_points_ = 0;
+    while ((1 << log2_points_) < points) log2_points_++;
+
+    computeTables();
+    reset();
+    return true;
+}
+
+int Spectrum::getPoints() const {
+    return points_;
+}
+
+void Spectrum::setWindow(Window window) {
+    window_ = window;
+    computeTables();
+}
+
+Window Spectrum::getWindow() const {
+    return window_;
+}
+
+void Spectrum::setStyle(SpectrumStyle style) {
+    style_ = style;
+}
+
+SpectrumStyle Spectrum::getStyle() const {
+    return style_;
+}
+
+void Spectrum::setRange(int floor_db) {
+    floor_db10_ = std::min(-10, floor_db * 10);
+}
+
+void Spectrum::setPeakHold(int decay_db, int hold) {
+    decay_db10_ = std::max(0, decay_db * 10);
+    hold_ = std::max(0, std::min(hold, 255));
+}
+
+void Spectrum::setTimeBudget(uint32_t budget_us) {
+    budget_us_ = budget_us;
+}
+
+void Spectrum::computeTables() {
+    stage_ = Stage::Idle;
+
+    for (int k = 0; k < MAX_BINS; k++) {
+        double angle = 2.0 * M_PI * k / MAX_POINTS;
+        cos_[k] = (int16_t) std::lround(std::cos(angle) * 32767.0);
+        sin_[k] = (int16_t) std::lround(std::sin(angle) * 32767.0);
+    }
+
+    for (int i = 0; i < points_; i++) {
+        double phase = 2.0 * M_PI * i / (points_ - 1);
+        double w = 1.0;
+        switch (window_) {
+            case Window::Hann: w = 0.5 - 0.5 * std::cos(phase); break;
+            case Window::Hamming: w = 0.54 - 0.46 * std::cos(phase); break;
+            case Window::Blackman: w = 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase); break;
+            default: break;
+        }
+        window_table_[i] = (int16_t) std::lround(w * 32767.0);
+    }
+}
+
+void Spectrum::reset() {
+    stage_ = Stage::Idle;
+    peak_bin_ = 0;
+
+    for (int k = 0; k < MAX_BINS; k++) {
+        power_db10_[k] = level_db10_[k] = peak_db10_[k] = (int16_t) floor_db10_;
+        peak_age_[k] = 0;
+    }
+}
+
+// ############################################################################
+// Transform
+// ############################################################################
+
+bool Spectrum::start(const int* ring, size_t ring_size, size_t end) {
+    if (Stage::Idle != stage_ || nullptr == ring || ring_size < (size_t) points_) {
+        return false;
+    }
+
+    auto first = (end + ring_size - points_) % ring_size;
+
+    int64_t sum = 0;
+    for (int i = 0; i < points_; i++) {
+        sum += ring[(first + i) % ring_size];
+    }
+    int mean = (int) (sum / points_);
+
+    // remove DC, convert to Q15, apply the window and store bit reversed
+
+    for (int i = 0; i < points_; i++) {
+        int v = (ring[(first + i) % ring_size] - mean) << INPUT_SHIFT;
+        v = std::max(-32768, std::min(32767, v));
+
+        int j = 0;
+        for (int b = 0; b < log2_points_; b++) {
+            j |= ((i >> b) & 0x1) << (log2_points_ - 1 - b);
+        }
+
+        re_[j] = mulQ15((int16_t) v, window_table_[i]);
+        im_[j] = 0;
+    }
+
+    stage_ = Stage::Butterflies;
+    stage_span_ = 1;
+    position_ = 0;
+
+    return true;
+}
+
+bool Spectrum::butterflies(size_t count) {
+    auto half = (size_t) points_ / 2;
+    auto twiddle_stride = (size_t) MAX_POINTS / (2 * stage_span_);
+
+    while (count-- > 0) {
+        auto group = position_ / stage_span_;
+        auto j = position_ % stage_span_;
+        auto i0 = group * 2 * stage_span_ + j;
+        auto i1 = i0 + stage_span_;
+
+        auto c = cos_[j * twiddle_stride];
+        auto s = sin_[j * twiddle_stride];
+
+        // t = x1 * e^(-i*angle), outputs scaled by 1/2 to avoid overflow
+        int32_t t_re = ((int32_t) re_[i1] * c + (int32_t) im_[i1] * s) >> 15;
+        int32_t t_im = ((int32_t) im_[i1] * c - (int32_t) re_[i1] * s) >> 15;
+
+        int32_t x_re = re_[i0];
+        int32_t x_im = im_[i0];
+
+        re_[i0] = (int16_t) ((x_re + t_re) >> 1);
+        im_[i0] = (int16_t) ((x_im + t_im) >> 1);
+        re_[i1] = (int16_t) ((x_re - t_re) >> 1);
+        im_[i1] = (int16_t) ((x_im - t_im) >> 1);
+
+        if (++position_ >= half) {
+            position_ = 0;
+            stage_span_ *= 2;
+            if (stage_span_ >= points_) return true;
+            twiddle_stride = (size_t) MAX_POINTS / (2 * stage_span_);
+        }
+    }
+
+    return false;
+}
+
+int Spectrum::toDecibel(uint32_t power) {
+    if (0 == power) {
+        return -2000;
+    }
+
+    // log2 from the leading bit and a table for the next five bits
+
+    int exponent = 31;
+    while (0 == (power & 0x80000000u)) {
+        power <<= 1;
+        exponent--;
+    }
+
+    int log2_q8 = exponent * 256 + LOG2_TABLE[(power >> 26) & 0x1f];
+
+    // 10*log10(x) = 3.0103*log2(x), in 0.1 dB
+    return ((log2_q8 * 7706) >> 16) - FULL_SCALE_DB10;
+}
+
+bool Spectrum::magnitudes(size_t count) {
+    auto bins = (size_t) points_ / 2;
+
+    while (count-- > 0) {
+        auto k = position_;
+        uint32_t power = (uint32_t) ((int32_t) re_[k] * re_[k]) + (uint32_t) ((int32_t) im_[k] * im_[k]);
+        power_db10_[k] = (int16_t) std::max(floor_db10_, toDecibel(power));
+
+        if (++position_ >= bins) return true;
+    }
+
+    return false;
+}
+
+void Spectrum::finish() {
+    auto bins = points_ / 2;
+    peak_bin_ = 1;
+
+    for (int k = 0; k < bins; k++) {
+        int power = power_db10_[k];
+
+        // levels rise immediately and fall with the decay rate
+        level_db10_[k] = (int16_t) std::max(power, level_db10_[k] - decay_db10_);
+
+        if (power >= peak_db10_[k]) {
+            peak_db10_[k] = (int16_t) power;
+            peak_age_[k] = 0;
+        } else if (peak_age_[k] < hold_) {
+            peak_age_[k]++;
+        } else {
+            peak_db10_[k] = (int16_t) std::max((int) level_db10_[k], peak_db10_[k] - decay_db10_);
+        }
+
+        if (k > 0 && power > power_db10_[peak_bin_]) peak_bin_ = k;
+    }
+}
+
+bool Spectrum::process() {
+    TRACE_SCOPE("spectrum.process");
+
+    if (Stage::Idle == stage_) {
+        return false;
+    }
+
+    auto start_time = esp_timer_get_time();
+
+    for (;;) {
+        if (Stage::Butterflies == stage_) {
+            if (butterflies(STEP_SIZE)) {
+                stage_ = Stage::Magnitude;
+                position_ = 0;
+            }
+        } else if (magnitudes(STEP_SIZE)) {
+            stage_ = Stage::Idle;
+            finish();
+            return true;
+        }
+
+        if (0 != budget_us_ && esp_timer_get_time() - start_time >= (int64_t) budget_us_) {
+            return false;
+        }
+    }
+}
+
+bool Spectrum::isBusy() const {
+    return Stage::Idle != stage_;
+}
+
+int Spectrum::getPeakBin() const {
+    return peak_bin_;
+}
+
+int Spectrum::getLevel(int bin) const {
+    if (bin < 0 || bin >= points_ / 2) return floor_db10_;
+    return level_db10_[bin];
+}
+
+// ############################################################################
+// Rendering
+// ############################################################################
+
+void Spectrum::draw(Display* display, int x1, int y1, int x2, int y2) {
+    int width = x2 - x1 + 1;
+    int height = y2 - y1 + 1;
+    int bins = points_ / 2 - 1;             // without DC
+    if (width <= 0 || height <= 0) return;
+
+    auto toScreen = [&](int db10) {
+        int v = std::max(floor_db10_, std::min(0, db10));
+        return y2 - (v - floor_db10_) * (height - 1) / -floor_db10_;
+    };
+
+    int last_y = 0;
+
+    for (int x = 0; x < width; x++) {
+        int first_bin = 1 + x * bins / width;
+        int last_bin = std::max(first_bin, (x + 1) * bins / width);
+
+        int level = floor_db10_;
+        int peak = floor_db10_;
+        for (int k = first_bin; k <= last_bin; k++) {
+            level = std::max(level, (int) level_db10_[k]);
+            peak = std::max(peak, (int) peak_db10_[k]);
+        }
+
+        int y = toScreen(level);
+
+        if (SpectrumStyle::Bars == style_) {
+            if (level > floor_db10_) display->drawVerticalLine(x1 + x, y, y2);
+        } else if (x > 0) {
+            display->drawLine(x1 + x - 1, last_y, x1 + x, y);
+        }
+
+        if (peak > level) {
+            display->drawPixel(x1 + x, toScreen(peak));
+        }
+
+        last_y = y;
+    }
+}
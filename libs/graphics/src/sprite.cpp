@@ -0,0 +1,249 @@
+//
+// Sprites
+//
+#include "graphics/sprite.h"
+#include "graphics/bitmap.h"
+#include "graphics/display.h"
+
+#include <memory.h>
+#include <algorithm>
+
+#include "sys/trace.h"
+
+using namespace graphics;
+
+SpriteManager::SpriteManager(Display* display)
+    : display_(display) {}
+
+// ############################################################################
+// Sprite management
+// ############################################################################
+
+int SpriteManager::create(const Bitmap* const* frames, size_t num_frames) {
+    if (nullptr == frames || 0 == num_frames) {
+        return -1;
+    }
+
+    for (int id = 0; id < MAX_SPRITES; id++) {
+        auto& sprite = sprites_[id];
+        if (sprite.used) continue;
+
+        int max_width = 0;
+        int max_height = 0;
+        for (size_t i = 0; i < num_frames; i++) {
+            if (nullptr == frames[i]) return -1;
+            max_width = std::max(max_width, (int) frames[i]->width());
+            max_height = std::max(max_height, (int) frames[i]->height());
+        }
+
+        sprite.used = true;
+        sprite.visible = true;
+        sprite.changed = true;
+        sprite.drawn = false;
+        sprite.release = false;
+        sprite.frames = frames;
+        sprite.num_frames = num_frames;
+        sprite.frame = 0;
+        sprite.x = 0;
+        sprite.y = 0;
+
+        // one extra page for positions that are not page aligned
+        sprite.saved.resize(max_width * ((max_height + 7) / 8 + 1));
+
+        return id;
+    }
+
+    return -1;
+}
+
+void SpriteManager::destroy(int id) {
+    auto sprite = get(id);
+    if (nullptr == sprite) return;
+
+    sprite->visible = false;
+    sprite->changed = true;
+    sprite->release = true;
+}
+
+SpriteManager::Sprite* SpriteManager::get(int id) {
+    if (id < 0 || id >= MAX_SPRITES || !sprites_[id].used || sprites_[id].release) return nullptr;
+    return &sprites_[id];
+}
+
+const SpriteManager::Sprite* SpriteManager::get(int id) const {
+    if (id < 0 || id >= MAX_SPRITES || !sprites_[id].used || sprites_[id].release) return nullptr;
+    return &sprites_[id];
+}
+
+void SpriteManager::setPosition(int id, int x, int y) {
+    auto sprite = get(id);
+    if (nullptr == sprite || (x == sprite->x && y == sprite->y)) return;
+
+    sprite->x = x;
+    sprite->y = y;
+    sprite->changed = true;
+}
+
+void SpriteManager::setFrame(int id, int frame) {
+    auto sprite = get(id);
+    if (nullptr == sprite || frame < 0 || frame >= (int) sprite->num_frames || frame == sprite->frame) return;
+
+    sprite->frame = frame;
+    sprite->changed = true;
+}
+
+void SpriteManager::setVisible(int id, bool visible) {
+    auto sprite = get(id);
+    if (nullptr == sprite || visible == sprite->visible) return;
+
+    sprite->visible = visible;
+    sprite->changed = true;
+}
+
+int SpriteManager::getFrame(int id) const {
+    auto sprite = get(id);
+    return (nullptr != sprite) ? sprite->frame : -1;
+}
+
+int SpriteManager::getNumFrames(int id) const {
+    auto sprite = get(id);
+    return (nullptr != sprite) ? (int) sprite->num_frames : 0;
+}
+
+// ############################################################################
+// Drawing
+// ############################################################################
+
+void SpriteManager::update() {
+
+    bool affected[MAX_SPRITES];
+    bool has_area[MAX_SPRITES];
+    Rectangle area[MAX_SPRITES];
+
+    bool changed = false;
+    for (int i = 0; i < MAX_SPRITES; i++) {
+        auto& sprite = sprites_[i];
+        affected[i] = sprite.used && sprite.changed;
+        has_area[i] = sprite.used && sprite.visible && !sprite.release && getArea(sprite, area[i]);
+        changed |= affected[i];
+    }
+
+    if (!changed) return;
+
+    TRACE_SCOPE("sprites.update");
+
+    // sprites sharing pages with affected sprites need to be restored and redrawn, too
+    bool grow = true;
+    while (grow) {
+        grow = false;
+        for (int i = 0; i < MAX_SPRITES; i++) {
+            if (!affected[i]) continue;
+            for (int j = 0; j < MAX_SPRITES; j++) {
+                if (affected[j] || !sprites_[j].used) continue;
+
+                auto& a = sprites_[i];
+                auto& b = sprites_[j];
+                bool overlap = (a.drawn && b.drawn && a.saved_rect.intersects(b.saved_rect)) ||
+                               (a.drawn && has_area[j] && a.saved_rect.intersects(area[j])) ||
+                               (has_area[i] && b.drawn && area[i].intersects(b.saved_rect)) ||
+                               (has_area[i] && has_area[j] && area[i].intersects(area[j]));
+                if (overlap) {
+                    affected[j] = true;
+                    grow = true;
+                }
+            }
+        }
+    }
+
+    auto old_layer = display_->setLayer(nullptr);
+
+    // restore in reverse drawing order
+    for (int i = MAX_SPRITES - 1; i >= 0; i--) {
+        if (affected[i] && sprites_[i].drawn) {
+            restoreBackground(sprites_[i]);
+        }
+    }
+
+    for (int i = 0; i < MAX_SPRITES; i++) {
+        if (!affected[i]) continue;
+
+        auto& sprite = sprites_[i];
+        if (has_area[i]) {
+            saveBackground(sprite, area[i]);
+            display_->drawBitmap(sprite.frames[sprite.frame], sprite.x, sprite.y);
+        }
+
+        sprite.changed = false;
+        if (sprite.release) {
+            sprite.used = false;
+            sprite.release = false;
+            sprite.frames = nullptr;
+        }
+    }
+
+    display_->setLayer(old_layer);
+}
+
+void SpriteManager::restore() {
+    auto old_layer = display_->setLayer(nullptr);
+
+    for (int i = MAX_SPRITES - 1; i >= 0; i--) {
+        auto& sprite = sprites_[i];
+        if (sprite.drawn) {
+            restoreBackground(sprite);
+            sprite.changed = true;
+        }
+    }
+
+    display_->setLayer(old_layer);
+}
+
+bool SpriteManager::getArea(const Sprite& sprite, Rectangle& area) const {
+    auto bitmap = sprite.frames[sprite.frame];
+    auto device = display_->device();
+
+    int left = std::max(sprite.x, 0);
+    int right = std::min(sprite.x + (int) bitmap->width() - 1, (int) device->width() - 1);
+    int top = std::max(sprite.y, 0);
+    int bottom = std::min(sprite.y + (int) bitmap->height() - 1, (int) device->height() - 1);
+
+    if (left > right || top > bottom) return false;
+
+    // whole pages, bytes are saved and restored as a unit
+    area.set(left, right, (top / 8) * 8, std::min((bottom / 8) * 8 + 7, (int) device->height() - 1));
+
+    return true;
+}
+
+void SpriteManager::saveBackground(Sprite& sprite, const Rectangle& area) {
+    auto device = display_->device();
+    auto buffer = device->buffer();
+    int width = device->width();
+    int bytes = area.right - area.left + 1;
+
+    uint8_t* dest = sprite.saved.data();
+    for (int page = area.top / 8; page <= area.bottom / 8; page++) {
+        memcpy(dest, buffer + page * width + area.left, bytes);
+        dest += bytes;
+    }
+
+    sprite.saved_rect = area;
+    sprite.drawn = true;
+}
+
+void SpriteManager::restoreBackground(Sprite& sprite) {
+    auto device = display_->device();
+    auto buffer = device->buffer();
+    int width = device->width();
+    const auto& area = sprite.saved_rect;
+    int bytes = area.right - area.left + 1;
+
+    const uint8_t* src = sprite.saved.data();
+    for (int page = area.top / 8; page <= area.bottom / 8; page++) {
+        memcpy(buffer + page * width + area.left, src, bytes);
+        src += bytes;
+    }
+
+    device->markRegion(area);
+    sprite.drawn = false;
+}
@@ -0,0 +1,177 @@
+//
+// Tile Map
+//
+#include "graphics/tilemap.h"
+#include "graphics/base.h"
+#include "graphics/device.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#include "sys/trace.h"
+
+using namespace graphics;
+
+namespace {
+
+const uint8_t EMPTY_TILE[TileMap::TILE_SIZE] = {0};
+
+}  // namespace
+
+TileMap::TileMap() {}
+
+// ############################################################################
+// Setup
+// ############################################################################
+
+void TileMap::setTiles(const uint8_t* tiles, size_t num_tiles) {
+    tiles_ = tiles;
+    num_tiles_ = (nullptr != tiles) ? num_tiles : 0;
+    valid_ = false;
+}
+
+void TileMap::setMap(const uint8_t* map, int width, int height) {
+    map_ = map;
+    map_width_ = (nullptr != map) ? std::max(0, width) : 0;
+    map_height_ = (nullptr != map) ? std::max(0, height) : 0;
+    valid_ = false;
+}
+
+void TileMap::setWrap(bool wrap) {
+    wrap_ = wrap;
+    valid_ = false;
+}
+
+void TileMap::setViewport(int left, int right, int first_page, int last_page) {
+    left_ = left;
+    right_ = right;
+    first_page_ = first_page;
+    last_page_ = last_page;
+    valid_ = false;
+}
+
+void TileMap::setCamera(int x, int y) {
+    camera_x_ = x;
+    camera_y_ = y;
+}
+
+int TileMap::cameraX() const {
+    return camera_x_;
+}
+
+int TileMap::cameraY() const {
+    return camera_y_;
+}
+
+void TileMap::setHardwareScroll(bool enable) {
+    if (hardware_scroll_ == enable) return;
+    hardware_scroll_ = enable;
+    valid_ = false;
+}
+
+bool TileMap::isHardwareScroll() const {
+    return hardware_scroll_;
+}
+
+void TileMap::invalidate() {
+    valid_ = false;
+}
+
+// ############################################################################
+// Rendering
+// ############################################################################
+
+const uint8_t* TileMap::tile(int tx, int ty) const {
+    if (0 == map_width_ || 0 == map_height_) return EMPTY_TILE;
+
+    if (wrap_) {
+        tx = floorMod(tx, map_width_);
+        ty = floorMod(ty, map_height_);
+    } else if (tx < 0 || ty < 0 || tx >= map_width_ || ty >= map_height_) {
+        return EMPTY_TILE;
+    }
+
+    size_t index = map_[ty * map_width_ + tx];
+    if (index >= num_tiles_) return EMPTY_TILE;
+
+    return tiles_ + index * TILE_SIZE;
+}
+
+void TileMap::drawPageRows(uint8_t* dest, int world_y, int left, int right) {
+
+    // one page row of the viewport shows map rows world_y..world_y+7,
+    // spread over two tile rows unless world_y is tile aligned
+
+    auto ty = floorDiv(world_y, TILE_SIZE);
+    auto shift = floorMod(world_y, TILE_SIZE);
+
+    auto x = left;
+    auto world_x = camera_x_;
+
+    while (x <= right) {
+        auto tx = floorDiv(world_x, TILE_SIZE);
+        auto col = floorMod(world_x, TILE_SIZE);
+        auto count = std::min(TILE_SIZE - col, right - x + 1);
+
+        auto upper = tile(tx, ty) + col;
+        auto lower = tile(tx, ty + 1) + col;
+        auto out = dest + x;
+
+        for (int i = 0; i < count; i++) {
+            auto column = (uint16_t) (upper[i] | (lower[i] << 8));
+            out[i] = (uint8_t) (column >> shift);
+        }
+
+        x += count;
+        world_x += count;
+    }
+}
+
+void TileMap::renderPage(uint8_t* dest, int width, int index) {
+
+    // with hardware scrolling the viewport spans the page, content page
+    // index holds map rows index*8 to index*8+7
+
+    drawPageRows(dest, index * 8, 0, width - 1);
+}
+
+void TileMap::drawAll(Device* device) {
+
+    // the configured viewport is kept as set, only the drawn part is
+    // limited to the panel
+
+    auto left = std::max(0, left_);
+    auto right = std::min((int) device->width() - 1, right_);
+    auto first_page = std::max(0, first_page_);
+    auto last_page = std::min((int) device->height() / 8 - 1, last_page_);
+
+    if (left > right) return;
+
+    for (int page = first_page; page <= last_page; page++) {
+        auto dest = device->buffer() + page * device->width();
+        drawPageRows(dest, camera_y_ + (page - first_page) * 8, left, right);
+        device->markRegion(left, right, page * 8);
+    }
+}
+
+void TileMap::draw(Device* device) {
+    TRACE_SCOPE("tilemap.draw");
+
+    if (nullptr == device) return;
+
+    if (hardware_scroll_) {
+
+        // the scroller redraws the whole panel unless only the camera row moved
+
+        if (!valid_ || camera_x_ != drawn_x_) VerticalScroller::invalidate();
+        setPosition(camera_y_);
+        update(device);
+
+    } else if (!valid_ || camera_x_ != drawn_x_ || camera_y_ != drawn_y_) {
+        drawAll(device);
+    }
+
+    drawn_x_ = camera_x_;
+    drawn_y_ = camera_y_;
+    valid_ = true;
+}
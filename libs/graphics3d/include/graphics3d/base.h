@@ -84,6 +84,69 @@ class Vertex {
         void set(float _x, float _y, float _z);
 };
 
+/**
+ * Compact mesh data, suitable for constexpr/flash resident storage.
+ * Positions are quantized to int16 per axis: p = q * scale + bias.
+ * Triangles are stored as strips, separated by restart indices.
+ */
+struct PackedMesh {
+    static const uint8_t RESTART_INDEX8 = 0xff;
+    static const uint16_t RESTART_INDEX16 = 0xffff;
+
+    const int16_t* positions;   ///< quantized positions (x, y, z per vertex)
+    uint16_t num_vertices;      ///< number of vertices
+    const uint8_t* indices8;    ///< 8-bit strip indices (or nullptr)
+    const uint16_t* indices16;  ///< 16-bit strip indices (or nullptr)
+    uint16_t num_indices;       ///< number of strip indices including restarts
+    float scale[3];             ///< per-axis dequantization scale
+    float bias[3];              ///< per-axis dequantization bias
+    float radius;               ///< bounding radius around origin
+};
+
+/**
+ * Rigid bone pose in quantized position space: q' = (rotation * q >> 14) + translation
+ */
+struct BonePose {
+    int16_t rotation[9];        ///< Q14 rotation matrix, row major
+    int32_t translation[3];     ///< translation in quantized units
+};
+
+/**
+ * Precomputed keyframe animation for packed meshes.
+ * Morph frames hold full quantized positions using the scale and bias of the mesh,
+ * bone frames hold one pose per bone. Every vertex is bound to a single bone.
+ */
+struct MeshAnimation {
+    static const int ROTATION_SHIFT = 14;
+    static const size_t MAX_BONES = 32;
+
+    const int16_t* morph_frames;    ///< num_morph_frames * num_vertices * 3 (or nullptr)
+    uint16_t num_morph_frames;      ///< number of morph keyframes
+    const uint8_t* vertex_bones;    ///< bone index per vertex (or nullptr)
+    const BonePose* bone_frames;    ///< num_bone_frames * num_bones poses (or nullptr)
+    uint16_t num_bone_frames;       ///< number of bone keyframes
+    uint8_t num_bones;              ///< number of bones (max. MAX_BONES)
+    float frame_duration;           ///< seconds per keyframe
+    bool loop;                      ///< wrap around after the last keyframe
+};
+
+/**
+ * Mesh level of detail
+ */
+class MeshLevel {
+    public:
+        const std::vector<Vertex>* vertices;
+        const std::vector<Face>* faces;
+        const PackedMesh* data;
+        float max_radius;   ///< max. projected bounding radius (pixels) to use this level
+
+    public:
+        constexpr MeshLevel(const std::vector<Vertex>* _vertices, const std::vector<Face>* _faces, float _max_radius)
+            : vertices(_vertices), faces(_faces), data(nullptr), max_radius(_max_radius) {}
+        constexpr MeshLevel(const PackedMesh* _data, float _max_radius)
+            : vertices(nullptr), faces(nullptr), data(_data), max_radius(_max_radius) {}
+};
+
 /**
  * Mesh data
  */
@@ -99,6 +162,21 @@ class Mesh {
         void setFaces(const std::vector<Face>&& faces);
         void clearFaces();
 
+    public:
+        void setPackedData(const PackedMesh* data);
+        void clearPackedData();
+
+    public:
+        void setAnimation(const MeshAnimation* animation);
+        void clearAnimation();
+        void setAnimationTime(float time);
+        void animate(float delta);
+
+    public:
+        void setLevels(const std::vector<MeshLevel>& levels);
+        void setLevels(const MeshLevel* levels, size_t num_levels);
+        void clearLevels();
+
     public:
         void setPosition(const Point& position);
         void setPosition(float x, float y, float z);
@@ -123,6 +201,19 @@ class Mesh {
         const std::vector<Vertex>& vertices() const;
         const std::vector<Face>& faces() const;
 
+        size_t numLevels() const;
+        const std::vector<Vertex>& vertices(size_t level) const;
+        const std::vector<Face>& faces(size_t level) const;
+        const PackedMesh* packedData(size_t level = 0) const;
+        float levelRadius(size_t level) const;
+        float boundingRadius() const;
+
+        const MeshAnimation* animation() const;
+        float animationTime() const;
+
+    private:
+        void updateBounds();
+
     private:
         // vertices and faces
         std::vector<Vertex> vertices_;
@@ -131,6 +222,18 @@ class Mesh {
         std::vector<Face> faces_;
         const std::vector<Face>* faces_ref_{nullptr};
 
+        // compact data, used instead of vertices and faces if set
+        const PackedMesh* packed_data_{nullptr};
+
+        // reduced levels of detail, coarsest last
+        const MeshLevel* levels_{nullptr};
+        size_t num_levels_{0};
+        float bounding_radius_{0.0f};
+
+        // keyframe animation (packed data only)
+        const MeshAnimation* animation_{nullptr};
+        float animation_time_{0.0f};
+
     private:
         // mesh parameters
         // note: simplification, usually not directly stored at a mesh
@@ -7,10 +7,57 @@
 #include "graphics/graphics.h"
 #include "graphics3d/base.h"
 #include "graphics3d/renderer.h"
+#include <cstdio>
 #include <vector>
 
 namespace graphics {
 
+/**
+ * Renderer statistics of one frame
+ */
+struct RenderStats {
+    uint32_t vertices_transformed{0};
+    uint32_t faces_backface_culled{0};
+    uint32_t faces_frustum_culled{0};
+    uint32_t triangles_rasterized{0};
+    uint32_t pixels_tested{0};      ///< z-buffer tests
+    uint32_t pixels_rejected{0};    ///< z-buffer tests failed
+    uint32_t project_us{0};         ///< vertex transformation and projection
+    uint32_t raster_us{0};          ///< face setup and rasterization
+    uint32_t flush_us{0};           ///< z-buffer to display buffer transfer
+
+    void reset();
+    int format(char* buf, size_t size) const;
+    void format(Formatter& text) const;
+    int formatCsv(char* buf, size_t size) const;
+    static const char* csvHeader();
+};
+
+/**
+ * Structure-of-arrays vertex storage. Component arrays are 16-byte aligned
+ * and padded to multiples of 4 to allow vectorized processing.
+ */
+class VertexArray {
+
+    public:
+        static const size_t ALIGNMENT = 16;
+
+    public:
+        void reserve(size_t count);
+        size_t capacity() const;
+
+    public:
+        float* x{nullptr};              ///< transformed positions
+        float* y{nullptr};
+        float* z{nullptr};
+        int32_t* screen_x{nullptr};     ///< projected screen coordinates
+        int32_t* screen_y{nullptr};
+
+    private:
+        std::vector<uint8_t> storage_;
+        size_t capacity_{0};
+};
+
 /**
  * Renderer
  */
@@ -27,12 +74,28 @@ class Renderer {
     public:
         void drawMesh(const Mesh* mesh, bool draw_wireframe=false);
 
+    public:
+        const RenderStats& stats() const;
+        bool openStatsLog(const char* filename);
+        void closeStatsLog();
+
+    public:
+        void enableLevelOfDetail(bool enable);
+        size_t selectLevel(const Mesh* mesh) const;
+        float projectedRadius(const Mesh* mesh) const;
+
     private:
         void alloc();
         void free();
         void flushBuffers();
-        void project(const Mesh* mesh);
-        Point2 toScreen(const Point& p);
+        void project(const Mesh* mesh, const std::vector<Vertex>& vertices);
+        void project(const Mesh* mesh, const PackedMesh* data);
+        void transform(const Mesh* mesh, size_t count);
+        void toScreen(size_t count);
+        void drawPackedMesh(const Mesh* mesh, const PackedMesh* data, bool draw_wireframe);
+        void drawFace(int a, int b, int c, int d, int num_vertices, bool draw_wireframe);
+        bool isOutside(const Point2& a, const Point2& b, const Point2& c, const Point2& d) const;
+        void blendBonePoses(const MeshAnimation* animation, int frame0, int frame1, int32_t weight);
 
     public: // private:
         void drawPixelClipped(int x, int y, float z, int col);
@@ -53,12 +116,17 @@ class Renderer {
     private:
         graphics::Display* display_;
         graphics::Bitmap* screen_buffer_{nullptr};
-        std::vector<Point> projection_cache_;
+        VertexArray projection_cache_;
+        BonePose bone_poses_[MeshAnimation::MAX_BONES];
         float display_ratio_{1.0f};
         Point camera_;
         Point light_;
         bool backface_culling_{true};
         bool lines_ignore_zbuffer_{false};
+        bool level_of_detail_{true};
+        RenderStats stats_;
+        RenderStats last_stats_;
+        FILE* stats_log_{nullptr};
 };
 
 }  // namespace
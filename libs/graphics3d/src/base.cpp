@@ -4,6 +4,7 @@
 #include "graphics3d/base.h"
 #include "graphics3d/renderer.h"
 
+#include <algorithm>
 #include <cmath>
 
 using namespace graphics;
@@ -132,16 +133,34 @@ void Vertex::set(float _x, float _y, float _z) {
 void Mesh::setVertices(const std::vector<Vertex>& vertices) {
     clearVertices();
     vertices_ref_ = &vertices;
+    updateBounds();
 }
 
 void Mesh::setVertices(std::vector<Vertex>&& vertices) {
     clearVertices();
     vertices_ = vertices;
+    updateBounds();
 }
 
 void Mesh::clearVertices() {
     vertices_ref_ = nullptr;
     vertices_.clear();
+    bounding_radius_ = 0.0f;
+}
+
+void Mesh::updateBounds() {
+    if (nullptr != packed_data_) {
+        bounding_radius_ = packed_data_->radius;
+        return;
+    }
+
+    // radius of bounding sphere around the mesh origin (rotation center)
+    float max_length = 0.0f;
+    for (const auto& vertex : vertices()) {
+        float length = vertex.coords.length();
+        if (length > max_length) max_length = length;
+    }
+    bounding_radius_ = max_length;
 }
 
 void Mesh::setFaces(const std::vector<Face>& faces) {
@@ -159,6 +178,56 @@ void Mesh::clearFaces() {
     faces_.clear();
 }
 
+void Mesh::setPackedData(const PackedMesh* data) {
+    packed_data_ = data;
+    updateBounds();
+}
+
+void Mesh::clearPackedData() {
+    packed_data_ = nullptr;
+    updateBounds();
+}
+
+void Mesh::setAnimation(const MeshAnimation* animation) {
+    animation_ = animation;
+    animation_time_ = 0.0f;
+}
+
+void Mesh::clearAnimation() {
+    animation_ = nullptr;
+    animation_time_ = 0.0f;
+}
+
+void Mesh::setAnimationTime(float time) {
+    animation_time_ = time;
+}
+
+void Mesh::animate(float delta) {
+    animation_time_ += delta;
+    if (nullptr == animation_ || !animation_->loop) return;
+
+    // keep time bounded, looping animations wrap from the last to the first keyframe
+    auto num_frames = std::max(animation_->num_morph_frames, animation_->num_bone_frames);
+    float duration = num_frames * animation_->frame_duration;
+    if (duration > 0.0f && animation_time_ >= duration) {
+        animation_time_ = std::fmod(animation_time_, duration);
+    }
+}
+
+void Mesh::setLevels(const std::vector<MeshLevel>& levels) {
+    setLevels(levels.data(), levels.size());
+}
+
+void Mesh::setLevels(const MeshLevel* levels, size_t num_levels) {
+    levels_ = levels;
+    num_levels_ = (nullptr != levels) ? num_levels : 0;
+}
+
+void Mesh::clearLevels() {
+    levels_ = nullptr;
+    num_levels_ = 0;
+}
+
 void Mesh::setPosition(const Point& position) {
     position_ = position;
 }
@@ -230,3 +299,43 @@ const std::vector<Face>& Mesh::faces() const {
     if (nullptr != faces_ref_) return *faces_ref_;
     return faces_;
 }
+
+size_t Mesh::numLevels() const {
+    return 1 + num_levels_;
+}
+
+const std::vector<Vertex>& Mesh::vertices(size_t level) const {
+    static const std::vector<Vertex> empty;
+    if (0 == level || level >= numLevels()) return vertices();
+    auto vertices = levels_[level-1].vertices;
+    return (nullptr != vertices) ? *vertices : empty;
+}
+
+const std::vector<Face>& Mesh::faces(size_t level) const {
+    static const std::vector<Face> empty;
+    if (0 == level || level >= numLevels()) return faces();
+    auto faces = levels_[level-1].faces;
+    return (nullptr != faces) ? *faces : empty;
+}
+
+const PackedMesh* Mesh::packedData(size_t level) const {
+    if (0 == level || level >= numLevels()) return packed_data_;
+    return levels_[level-1].data;
+}
+
+float Mesh::levelRadius(size_t level) const {
+    if (0 == level || level >= numLevels()) return 0.0f;
+    return levels_[level-1].max_radius;
+}
+
+float Mesh::boundingRadius() const {
+    return bounding_radius_;
+}
+
+const MeshAnimation* Mesh::animation() const {
+    return animation_;
+}
+
+float Mesh::animationTime() const {
+    return animation_time_;
+}
@@ -4,14 +4,81 @@
 #include "graphics3d/base.h"
 #include "graphics3d/renderer.h"
 
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "graphics/format.h"
+#include "sys/trace.h"
+
+#include <algorithm>
+#include <cinttypes>
 #include <cmath>
 #include <cstring>
 
 using namespace graphics;
 
+static const char* TAG = "renderer";
+
 static const float PI = 3.14159274101257324219f;
 static const float PI_12 = PI*0.5f;
 
+static const int WEIGHT_SHIFT = 15;
+static const int32_t WEIGHT_ONE = 1 << WEIGHT_SHIFT;
+
+// keyframe pair and Q15 blend weight for the given animation time
+static void findKeyframes(const MeshAnimation* animation, int num_frames, float time, int& frame0, int& frame1, int32_t& weight) {
+
+    float pos = (animation->frame_duration > 0.0f) ? time / animation->frame_duration : 0.0f;
+
+    if (animation->loop) {
+        pos = std::fmod(pos, (float) num_frames);
+        if (pos < 0.0f) pos += (float) num_frames;
+    } else {
+        pos = std::max(0.0f, std::min(pos, (float) (num_frames - 1)));
+    }
+
+    frame0 = std::min((int) pos, num_frames - 1);
+    frame1 = frame0 + 1;
+    if (frame1 >= num_frames) frame1 = animation->loop ? 0 : num_frames - 1;
+
+    weight = std::min((int32_t) ((pos - (float) frame0) * (float) WEIGHT_ONE), WEIGHT_ONE - 1);
+}
+
+static inline void applyBonePose(const BonePose& pose, int32_t* v) {
+    const int16_t* r = pose.rotation;
+    int32_t x = v[0];
+    int32_t y = v[1];
+    int32_t z = v[2];
+    v[0] = ((r[0] * x + r[1] * y + r[2] * z) >> MeshAnimation::ROTATION_SHIFT) + pose.translation[0];
+    v[1] = ((r[3] * x + r[4] * y + r[5] * z) >> MeshAnimation::ROTATION_SHIFT) + pose.translation[1];
+    v[2] = ((r[6] * x + r[7] * y + r[8] * z) >> MeshAnimation::ROTATION_SHIFT) + pose.translation[2];
+}
+
+// ############################################################################
+// Vertex Array
+// ############################################################################
+
+void VertexArray::reserve(size_t count) {
+    if (count <= capacity_) return;
+
+    // pad component arrays to keep each of them aligned
+    size_t capacity = (count + 3) & ~((size_t) 3);
+    storage_.resize(capacity * (3 * sizeof(float) + 2 * sizeof(int32_t)) + ALIGNMENT);
+
+    auto base = ((uintptr_t) storage_.data() + ALIGNMENT - 1) & ~((uintptr_t) ALIGNMENT - 1);
+
+    x = (float*) base;
+    y = x + capacity;
+    z = y + capacity;
+    screen_x = (int32_t*) (z + capacity);
+    screen_y = screen_x + capacity;
+
+    capacity_ = capacity;
+}
+
+size_t VertexArray::capacity() const {
+    return capacity_;
+}
+
 // ############################################################################
 // Init
 // ############################################################################
@@ -20,6 +87,7 @@ Renderer::Renderer() {
 }
 
 Renderer::~Renderer() {
+    closeStatsLog();
     free();
 }
 
@@ -38,8 +106,88 @@ void Renderer::init(graphics::Display* display, bool enable_zbuffer) {
 }
 
 void Renderer::update() {
+    TRACE_SCOPE("renderer.update");
+
     if (nullptr != screen_buffer_) {
+        int64_t start_time = esp_timer_get_time();
         flushBuffers();
+        stats_.flush_us += (uint32_t) (esp_timer_get_time() - start_time);
+    }
+
+    // publish statistics of the finished frame
+    last_stats_ = stats_;
+    stats_.reset();
+
+    if (nullptr != stats_log_) {
+        char buf[128];
+        last_stats_.formatCsv(buf, sizeof(buf));
+        fprintf(stats_log_, "%s\n", buf);
+        fflush(stats_log_);
+    }
+}
+
+// ############################################################################
+// Statistics
+// ############################################################################
+
+void RenderStats::reset() {
+    *this = RenderStats();
+}
+
+int RenderStats::format(char* buf, size_t size) const {
+    Formatter text(buf, size);
+    format(text);
+    return (int) text.length();
+}
+
+void RenderStats::format(Formatter& text) const {
+    // printf-free and limited to digits and '/', the statistics overlay
+    // has no other glyphs: vertices/triangles/culled/microseconds
+    text.appendUnsigned(vertices_transformed).append('/')
+        .appendUnsigned(triangles_rasterized).append('/')
+        .appendUnsigned(faces_backface_culled + faces_frustum_culled).append('/')
+        .appendUnsigned(project_us + raster_us + flush_us);
+}
+
+int RenderStats::formatCsv(char* buf, size_t size) const {
+    return snprintf(buf, size, "%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32 ",%" PRIu32,
+                    vertices_transformed,
+                    faces_backface_culled,
+                    faces_frustum_culled,
+                    triangles_rasterized,
+                    pixels_tested,
+                    pixels_rejected,
+                    project_us,
+                    raster_us,
+                    flush_us);
+}
+
+const char* RenderStats::csvHeader() {
+    return "vertices,backface_culled,frustum_culled,triangles,pixels_tested,pixels_rejected,project_us,raster_us,flush_us";
+}
+
+const RenderStats& Renderer::stats() const {
+    return last_stats_;
+}
+
+bool Renderer::openStatsLog(const char* filename) {
+    closeStatsLog();
+
+    stats_log_ = fopen(filename, "w");
+    if (nullptr == stats_log_) {
+        ESP_LOGE(TAG, "failed to open statistics log: %s", filename);
+        return false;
+    }
+
+    fprintf(stats_log_, "%s\n", RenderStats::csvHeader());
+
+    return true;
+}
+
+void Renderer::closeStatsLog() {
+    if (nullptr != stats_log_) {
+        fclose(stats_log_);
+        stats_log_ = nullptr;
     }
 }
 
@@ -126,17 +274,125 @@ inline uint16_t Renderer::encodeZ(float z) {
 // 3D Projection
 // ############################################################################
 
-void Renderer::project(const Mesh* mesh) {
+void Renderer::project(const Mesh* mesh, const std::vector<Vertex>& vertices) {
+
+    auto count = vertices.size();
+    projection_cache_.reserve(count);
+
+    // gather model coordinates
+    float* __restrict px = projection_cache_.x;
+    float* __restrict py = projection_cache_.y;
+    float* __restrict pz = projection_cache_.z;
+
+    for (size_t index = 0; index < count; index++) {
+        const auto& coords = vertices[index].coords;
+        px[index] = coords.x;
+        py[index] = coords.y;
+        pz[index] = coords.z;
+    }
+
+    transform(mesh, count);
+    toScreen(count);
+}
+
+void Renderer::project(const Mesh* mesh, const PackedMesh* data) {
+
+    projection_cache_.reserve(data->num_vertices);
+
+    // keyframe animation only applies to the full detail data
+    const MeshAnimation* animation = (data == mesh->packedData()) ? mesh->animation() : nullptr;
+
+    const int16_t* morph0 = nullptr;
+    const int16_t* morph1 = nullptr;
+    int32_t morph_weight = 0;
+    const uint8_t* vertex_bones = nullptr;
+    int num_bones = 0;
+
+    if (nullptr != animation) {
+        int frame0, frame1;
+
+        if (nullptr != animation->morph_frames && animation->num_morph_frames > 0) {
+            findKeyframes(animation, animation->num_morph_frames, mesh->animationTime(), frame0, frame1, morph_weight);
+            size_t frame_size = (size_t) data->num_vertices * 3;
+            morph0 = animation->morph_frames + frame0 * frame_size;
+            morph1 = animation->morph_frames + frame1 * frame_size;
+        }
+
+        if (nullptr != animation->vertex_bones && nullptr != animation->bone_frames &&
+            animation->num_bone_frames > 0 && animation->num_bones <= MeshAnimation::MAX_BONES) {
+            int32_t bone_weight;
+            findKeyframes(animation, animation->num_bone_frames, mesh->animationTime(), frame0, frame1, bone_weight);
+            blendBonePoses(animation, frame0, frame1, bone_weight);
+            vertex_bones = animation->vertex_bones;
+            num_bones = animation->num_bones;
+        }
+    }
+
+    const int16_t* q = data->positions;
+    int32_t v[3];
+
+    float* __restrict px = projection_cache_.x;
+    float* __restrict py = projection_cache_.y;
+    float* __restrict pz = projection_cache_.z;
+
+    for (size_t index = 0; index < data->num_vertices; index++) {
+
+        if (nullptr != morph0) {
+            // blend morph targets in fixed point
+            v[0] = morph0[0] + (((int32_t) morph1[0] - morph0[0]) * morph_weight >> WEIGHT_SHIFT);
+            v[1] = morph0[1] + (((int32_t) morph1[1] - morph0[1]) * morph_weight >> WEIGHT_SHIFT);
+            v[2] = morph0[2] + (((int32_t) morph1[2] - morph0[2]) * morph_weight >> WEIGHT_SHIFT);
+            morph0 += 3;
+            morph1 += 3;
+        } else {
+            v[0] = q[0];
+            v[1] = q[1];
+            v[2] = q[2];
+        }
+        q += 3;
+
+        if (nullptr != vertex_bones) {
+            int bone = vertex_bones[index];
+            if (bone < num_bones) applyBonePose(bone_poses_[bone], v);
+        }
+
+        // dequantize
+        px[index] = (float) v[0] * data->scale[0] + data->bias[0];
+        py[index] = (float) v[1] * data->scale[1] + data->bias[1];
+        pz[index] = (float) v[2] * data->scale[2] + data->bias[2];
+    }
+
+    transform(mesh, data->num_vertices);
+    toScreen(data->num_vertices);
+}
+
+void Renderer::blendBonePoses(const MeshAnimation* animation, int frame0, int frame1, int32_t weight) {
+
+    const BonePose* poses0 = animation->bone_frames + frame0 * animation->num_bones;
+    const BonePose* poses1 = animation->bone_frames + frame1 * animation->num_bones;
+
+    for (int bone = 0; bone < animation->num_bones; bone++) {
+        const auto& a = poses0[bone];
+        const auto& b = poses1[bone];
+        auto& pose = bone_poses_[bone];
+
+        // linear blend of neighbouring keyframes, small steps keep the rotation close to orthonormal
+        for (int i = 0; i < 9; i++) {
+            pose.rotation[i] = (int16_t) (a.rotation[i] + (((int32_t) b.rotation[i] - a.rotation[i]) * weight >> WEIGHT_SHIFT));
+        }
+
+        for (int i = 0; i < 3; i++) {
+            pose.translation[i] = a.translation[i] + (int32_t) (((int64_t) b.translation[i] - a.translation[i]) * weight >> WEIGHT_SHIFT);
+        }
+    }
+}
+
+void Renderer::transform(const Mesh* mesh, size_t count) {
+    TRACE_SCOPE("renderer.transform");
 
     const auto& rotation = mesh->rotation();
     const auto& position = mesh->position();
     const auto& scale = mesh->scale();
-    const auto& vertices = mesh->vertices();
-
-    // ensure cache buffer size is enough
-    if (projection_cache_.size() < vertices.size()) {
-        projection_cache_.resize(vertices.size());
-    }
 
     // buffer sin/cos for rotation
     float s_x = std::sin(rotation.x);
@@ -144,47 +400,94 @@ void Renderer::project(const Mesh* mesh) {
     float s_y = std::sin(rotation.y);
     float c_y = std::cos(rotation.y);
 
-    // project vertices to screen coordinates
-
-    size_t index = 0;
-
-    for (auto& vertex : vertices) {
+    // combined scale, rotation (y, then x) and translation matrix
+    const float m00 = scale.x * c_y;
+    const float m01 = 0.0f;
+    const float m02 = scale.z * s_y;
+    const float m10 = scale.x * s_y * s_x;
+    const float m11 = scale.y * c_x;
+    const float m12 = -scale.z * c_y * s_x;
+    const float m20 = -scale.x * s_y * c_x;
+    const float m21 = scale.y * s_x;
+    const float m22 = scale.z * c_y * c_x;
+
+    float* __restrict px = (float*) __builtin_assume_aligned(projection_cache_.x, VertexArray::ALIGNMENT);
+    float* __restrict py = (float*) __builtin_assume_aligned(projection_cache_.y, VertexArray::ALIGNMENT);
+    float* __restrict pz = (float*) __builtin_assume_aligned(projection_cache_.z, VertexArray::ALIGNMENT);
+
+    stats_.vertices_transformed += count;
+
+    for (size_t i = 0; i < count; i++) {
+        float x = px[i];
+        float y = py[i];
+        float z = pz[i];
+        px[i] = m00 * x + m01 * y + m02 * z + position.x;
+        py[i] = m10 * x + m11 * y + m12 * z + position.y;
+        pz[i] = m20 * x + m21 * y + m22 * z + position.z;
+    }
+}
 
-        Point p = vertex.coords;
-        p *= scale;
+void Renderer::toScreen(size_t count) {
+
+    const float w = (float) display_->width() * 0.5f;
+    const float h = (float) display_->height() * 0.5f;
+    const float h_ratio = h * display_ratio_;
+    const float camera_x = camera_.x;
+    const float camera_y = camera_.y;
+    const float camera_z = camera_.z;
+
+    const float* __restrict px = (const float*) __builtin_assume_aligned(projection_cache_.x, VertexArray::ALIGNMENT);
+    const float* __restrict py = (const float*) __builtin_assume_aligned(projection_cache_.y, VertexArray::ALIGNMENT);
+    const float* __restrict pz = (const float*) __builtin_assume_aligned(projection_cache_.z, VertexArray::ALIGNMENT);
+    int32_t* __restrict sx = (int32_t*) __builtin_assume_aligned(projection_cache_.screen_x, VertexArray::ALIGNMENT);
+    int32_t* __restrict sy = (int32_t*) __builtin_assume_aligned(projection_cache_.screen_y, VertexArray::ALIGNMENT);
+
+    for (size_t i = 0; i < count; i++) {
+        // branch-free max(z_dist, 0.00001), a conditional division would prevent vectorization;
+        // equal to std::max within one ulp of rounding (std::max and fmaxf keep the NaN
+        // semantics and do not vectorize without -ffast-math)
+        float z_dist = pz[i] - camera_z;
+        z_dist = 0.5f * (z_dist + 0.00001f + std::fabs(z_dist - 0.00001f));
+        float z_factor = 1.0f / z_dist;
+        sx[i] = (int32_t) (w + (px[i] - camera_x) * z_factor * w);
+        sy[i] = (int32_t) (h + (py[i] - camera_y) * z_factor * h_ratio);
+    }
+}
 
-        auto& p2 = projection_cache_[index];
+// ############################################################################
+// Level of Detail
+// ############################################################################
 
-        p2.set(
-            (p.x * c_y + p.z * s_y),
-            p.y * c_x - (p.z * c_y - p.x * s_y) * s_x,
-            (p.z * c_y - p.x * s_y) * c_x + p.y * s_x
-        );
+void Renderer::enableLevelOfDetail(bool enable) {
+    level_of_detail_ = enable;
+}
 
-        p2 += position;
+float Renderer::projectedRadius(const Mesh* mesh) const {
+    const auto& scale = mesh->scale();
+    float max_scale = std::max(std::fabs(scale.x), std::max(std::fabs(scale.y), std::fabs(scale.z)));
 
-        index++;
-    }
+    float z_dist = mesh->position().z - camera_.z;
+    if (z_dist < 0.00001f) return 100000.0f;
 
+    // same projection as toScreen(): normalized x of 1.0 maps to half the display width
+    return (mesh->boundingRadius() * max_scale / z_dist) * (float) display_->width() * 0.5f;
 }
 
-Point2 Renderer::toScreen(const Point& p) {
-    Point2 s;
-
-    float z_dist = p.z - camera_.z;
+size_t Renderer::selectLevel(const Mesh* mesh) const {
+    auto num_levels = mesh->numLevels();
+    if (!level_of_detail_ || num_levels < 2) return 0;
 
-    float z_factor = z_dist >= 0.00001f ? 1.0f / z_dist : 100000.0f;
+    // reduced levels do not carry animation data
+    if (nullptr != mesh->animation()) return 0;
 
-    auto x_norm = (p.x - camera_.x) * z_factor;
-    auto y_norm = (p.y - camera_.y) * z_factor;
+    float radius = projectedRadius(mesh);
 
-    float w = (float) display_->width() * 0.5f;
-    float h = (float) display_->height() * 0.5f;
-
-    s.x = (int)  (w + (x_norm * w));
-    s.y = (int)  (h + (y_norm * h * display_ratio_));
+    // pick the coarsest level which is still good enough for the projected size
+    for (size_t level = num_levels - 1; level > 0; level--) {
+        if (radius <= mesh->levelRadius(level)) return level;
+    }
 
-    return s;
+    return 0;
 }
 
 // ############################################################################
@@ -192,97 +495,183 @@ Point2 Renderer::toScreen(const Point& p) {
 // ############################################################################
 
 void Renderer::drawMesh(const Mesh* mesh, bool draw_wireframe) {
+    TRACE_SCOPE("renderer.mesh");
 
-    const auto& faces = mesh->faces();
-    const auto& vertices = projection_cache_;
-    const auto& light = light_;
+    auto level = selectLevel(mesh);
+
+    auto data = mesh->packedData(level);
+    if (nullptr != data) {
+        drawPackedMesh(mesh, data, draw_wireframe);
+        return;
+    }
 
+    const auto& faces = mesh->faces(level);
     if (faces.empty()) return;
 
-    project(mesh);
+    int64_t start_time = esp_timer_get_time();
 
-    Point v3;
-    Point2 s3;
-    Vector center;
+    project(mesh, mesh->vertices(level));
+
+    int64_t project_time = esp_timer_get_time();
 
     for (const auto& face : faces) {
+        drawFace(face.a, face.b, face.c, face.d, (int) face.size, draw_wireframe);
+    }
+
+    stats_.project_us += (uint32_t) (project_time - start_time);
+    stats_.raster_us += (uint32_t) (esp_timer_get_time() - project_time);
+}
+
+void Renderer::drawPackedMesh(const Mesh* mesh, const PackedMesh* data, bool draw_wireframe) {
 
-        int num_vertices = face.size;
+    if (0 == data->num_indices) return;
 
-        // render quadric
-        // fetch current quadric
-        const auto& v0 = vertices[face.a];
-        auto s0 = toScreen(v0);
+    int64_t start_time = esp_timer_get_time();
 
-        const auto& v1 = vertices[face.b];
-        auto s1 = toScreen(v1);
+    project(mesh, data);
 
-        const auto& v2 = vertices[face.c];
-        auto s2 = toScreen(v2);
+    int64_t project_time = esp_timer_get_time();
 
-        if (4 == num_vertices) {
-            v3 = vertices[face.d];
-            s3 = toScreen(v3);
+    // decode triangle strips, every odd triangle has reversed winding order
+    int strip_length = 0;
+    int i0 = 0;
+    int i1 = 0;
 
-            // calculate center of quadric
-            center = {
-                (v0.x+v1.x+v2.x+v3.x)/4.0f,
-                (v0.y+v1.y+v2.y+v3.y)/4.0f,
-                (v0.z+v1.z+v2.z+v3.z)/4.0f
-            };
+    for (size_t i = 0; i < data->num_indices; i++) {
+        int index;
+        if (nullptr != data->indices8) {
+            index = data->indices8[i];
+            if (PackedMesh::RESTART_INDEX8 == index) index = -1;
         } else {
-            // calculate center of triangle
-            center = {
-                (v0.x+v1.x+v2.x)/3.0f,
-                (v0.y+v1.y+v2.y)/3.0f,
-                (v0.z+v1.z+v2.z)/3.0f
-            };
+            index = data->indices16[i];
+            if (PackedMesh::RESTART_INDEX16 == index) index = -1;
         }
 
-        // do some maths to calculate surface normal
-        Vector normal = Vector::crossProduct((v1 - v0), (v1 - v2)).normalize();
+        if (index < 0) {
+            strip_length = 0;
+            continue;
+        }
 
-        // get surface orientation against light source
-        Vector line = Vector::subtract(center, light).normalize();
-        float angle = std::asin((line.x * normal.x + line.y * normal.y + line.z * normal.z));
+        if (strip_length >= 2) {
+            if (0 == (strip_length & 1)) {
+                drawFace(i0, i1, index, 0, 3, draw_wireframe);
+            } else {
+                drawFace(i1, i0, index, 0, 3, draw_wireframe);
+            }
+        }
 
-        // do not draw if surface is facing backwards
-        if (backface_culling_ && angle <= 0.0f) continue;
+        i0 = i1;
+        i1 = index;
+        strip_length++;
+    }
 
-        // calculate intensity from angle
-        int col = (int) (angle / PI_12 * 256.0f);
-        if (col < 0) col = 0;
-        if (col > 255) col = 255;
+    stats_.project_us += (uint32_t) (project_time - start_time);
+    stats_.raster_us += (uint32_t) (esp_timer_get_time() - project_time);
+}
 
-        if (4 == num_vertices) {
+void Renderer::drawFace(int a, int b, int c, int d, int num_vertices, bool draw_wireframe) {
 
-            // render quadric with two triangles
-            drawTriangle(s0, v0.z, s1, v1.z, s3, v3.z, col);
-            drawTriangle(s1, v1.z, s2, v2.z, s3, v3.z, col);
+    const auto& vertices = projection_cache_;
+    const auto& light = light_;
 
-            // render wire-frame overlay
-            if (draw_wireframe) {
-                drawLine(s0, v0.z, s1, v1.z);
-                drawLine(s1, v1.z, s2, v2.z);
-                drawLine(s2, v2.z, s3, v3.z);
-                drawLine(s0, v0.z, s1, v1.z);
-            }
+    Point v3;
+    Point2 s3;
+    Vector center;
 
-        } else if (3 == num_vertices) {
+    // render quadric
+    // fetch current quadric
+    Point v0(vertices.x[a], vertices.y[a], vertices.z[a]);
+    Point2 s0(vertices.screen_x[a], vertices.screen_y[a]);
 
-            // render quadric with two triangles
-            drawTriangle(s0, v0.z, s1, v1.z, s2, v2.z, col);
+    Point v1(vertices.x[b], vertices.y[b], vertices.z[b]);
+    Point2 s1(vertices.screen_x[b], vertices.screen_y[b]);
 
-            // render wire-frame overlay
-            if (draw_wireframe) {
-                drawLine(s0, v0.z, s1, v1.z);
-                drawLine(s1, v1.z, s2, v2.z);
-                drawLine(s0, v0.z, s2, v2.z);
-            }
+    Point v2(vertices.x[c], vertices.y[c], vertices.z[c]);
+    Point2 s2(vertices.screen_x[c], vertices.screen_y[c]);
+
+    if (4 == num_vertices) {
+        v3.set(vertices.x[d], vertices.y[d], vertices.z[d]);
+        s3 = Point2(vertices.screen_x[d], vertices.screen_y[d]);
+
+        // calculate center of quadric
+        center = {
+            (v0.x+v1.x+v2.x+v3.x)/4.0f,
+            (v0.y+v1.y+v2.y+v3.y)/4.0f,
+            (v0.z+v1.z+v2.z+v3.z)/4.0f
+        };
+    } else {
+        // calculate center of triangle
+        center = {
+            (v0.x+v1.x+v2.x)/3.0f,
+            (v0.y+v1.y+v2.y)/3.0f,
+            (v0.z+v1.z+v2.z)/3.0f
+        };
+    }
+
+    // skip faces which are completely outside the screen
+    if (isOutside(s0, s1, s2, (4 == num_vertices) ? s3 : s2)) {
+        stats_.faces_frustum_culled++;
+        return;
+    }
+
+    // do some maths to calculate surface normal
+    Vector normal = Vector::crossProduct((v1 - v0), (v1 - v2)).normalize();
+
+    // get surface orientation against light source
+    Vector line = Vector::subtract(center, light).normalize();
+    float angle = std::asin((line.x * normal.x + line.y * normal.y + line.z * normal.z));
+
+    // do not draw if surface is facing backwards
+    if (backface_culling_ && angle <= 0.0f) {
+        stats_.faces_backface_culled++;
+        return;
+    }
+
+    // calculate intensity from angle
+    int col = (int) (angle / PI_12 * 256.0f);
+    if (col < 0) col = 0;
+    if (col > 255) col = 255;
+
+    if (4 == num_vertices) {
+
+        // render quadric with two triangles
+        drawTriangle(s0, v0.z, s1, v1.z, s3, v3.z, col);
+        drawTriangle(s1, v1.z, s2, v2.z, s3, v3.z, col);
+
+        // render wire-frame overlay
+        if (draw_wireframe) {
+            drawLine(s0, v0.z, s1, v1.z);
+            drawLine(s1, v1.z, s2, v2.z);
+            drawLine(s2, v2.z, s3, v3.z);
+            drawLine(s0, v0.z, s1, v1.z);
+        }
+
+    } else if (3 == num_vertices) {
+
+        // render quadric with two triangles
+        drawTriangle(s0, v0.z, s1, v1.z, s2, v2.z, col);
+
+        // render wire-frame overlay
+        if (draw_wireframe) {
+            drawLine(s0, v0.z, s1, v1.z);
+            drawLine(s1, v1.z, s2, v2.z);
+            drawLine(s0, v0.z, s2, v2.z);
         }
     }
 }
 
+bool Renderer::isOutside(const Point2& a, const Point2& b, const Point2& c, const Point2& d) const {
+    int w = display_->width();
+    int h = display_->height();
+
+    if (a.x < 0 && b.x < 0 && c.x < 0 && d.x < 0) return true;
+    if (a.x >= w && b.x >= w && c.x >= w && d.x >= w) return true;
+    if (a.y < 0 && b.y < 0 && c.y < 0 && d.y < 0) return true;
+    if (a.y >= h && b.y >= h && c.y >= h && d.y >= h) return true;
+
+    return false;
+}
+
 // ############################################################################
 // Low-Level Pixel Drawing
 // ############################################################################
@@ -296,8 +685,12 @@ void Renderer::drawPixelClipped(int x, int y, float z, int col) {
     uint16_t z_old = maskZ(buffer[index]);
     uint16_t z_new = encodeZ(z);
 
+    stats_.pixels_tested++;
+
     if (z_new >= z_old) {
         buffer[index] = z_new | ((col != 0) ? 0x8000 : 0x0);
+    } else {
+        stats_.pixels_rejected++;
     }
 
     screen_buffer_->unlock();
@@ -308,6 +701,7 @@ void Renderer::drawPixelClipped(int x, int y, float z, int col) {
 // ############################################################################
 
 void Renderer::drawTriangle(const Point2& a, float az, const Point2& b, float bz, const Point2& c, float cz, int intensity) {
+    stats_.triangles_rasterized++;
     if (screen_buffer_) {
         fillDitheredTriangle(a.x, a.y, az, b.x, b.y, bz, c.x, c.y, cz, intensity);
     } else {
@@ -421,6 +815,7 @@ void Renderer::drawDitheredHorizontalLine(int x, int y, float z1, int x2, float
     auto index = (y * bytesPerLine * 8) / bitsPerPixel + x;
 
     float z_diff = z2 - z1;
+    uint32_t rejected = 0;
 
     for (auto i=0; i<w; i++) {
         float z = z1 + (z_diff * (float) i) / (float) w;
@@ -435,12 +830,17 @@ void Renderer::drawDitheredHorizontalLine(int x, int y, float z1, int x2, float
         if (z_new >= z_old) {
             auto col = display_->getDitheredColor(x, y, intensity) ? graphics::Color::WHITE : graphics::Color::BLACK;
             buffer[index] = z_new | ((col != 0) ? 0x8000 : 0x0);
+        } else {
+            rejected++;
         }
 
         index++;
         ++x;
     }
 
+    stats_.pixels_tested += w;
+    stats_.pixels_rejected += rejected;
+
     screen_buffer_->unlock();
 }
 
@@ -505,8 +905,11 @@ void Renderer::drawLine(int x0, int y0, float z0, int x1, int y1, float z1, int
                 } else {
                     uint16_t z_old = maskZ(buffer[index]);
                     uint16_t z_new = encodeZ(z);
+                    stats_.pixels_tested++;
                     if (z_new >= z_old) {
                         buffer[index] = z_new | ((col != 0) ? 0x8000 : 0x0);
+                    } else {
+                        stats_.pixels_rejected++;
                     }
                 }
             }
@@ -553,8 +956,11 @@ void Renderer::drawLine(int x0, int y0, float z0, int x1, int y1, float z1, int
                 } else {
                     uint16_t z_old = maskZ(buffer[index]);
                     uint16_t z_new = encodeZ(z);
+                    stats_.pixels_tested++;
                     if (z_new >= z_old) {
                         buffer[index] = z_new | ((col != 0) ? 0x8000 : 0x0);
+                    } else {
+                        stats_.pixels_rejected++;
                     }
                 }
             }
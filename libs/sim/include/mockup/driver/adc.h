@@ -1,7 +1,18 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stdint.h>
+
 typedef int esp_err_t;
 
+#ifndef ESP_OK
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_TIMEOUT 0x107
+#endif
+
 typedef enum {
     ADC_CHANNEL_0 = 0, /*!< ADC channel */
     ADC_CHANNEL_1,     /*!< ADC channel */
@@ -57,3 +68,58 @@ typedef enum {
 int adc1_get_raw(adc1_channel_t channel);
 esp_err_t adc1_config_width(adc_bits_width_t width_bit);
 esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten);
+
+// Continuous (DMA) mode
+
+#define ADC_MAX_DELAY UINT32_MAX
+
+typedef enum {
+    ADC_CONV_SINGLE_UNIT_1 = 1, /*!< Only use ADC1 for conversion */
+    ADC_CONV_SINGLE_UNIT_2 = 2, /*!< Only use ADC2 for conversion */
+} adc_digi_convert_mode_t;
+
+typedef enum {
+    ADC_DIGI_OUTPUT_FORMAT_TYPE1, /*!< 12 bit data, 4 bit channel */
+    ADC_DIGI_OUTPUT_FORMAT_TYPE2,
+} adc_digi_output_format_t;
+
+typedef struct {
+    uint8_t atten;     /*!< Attenuation of this ADC channel */
+    uint8_t channel;   /*!< ADC channel */
+    uint8_t unit;      /*!< ADC unit */
+    uint8_t bit_width; /*!< ADC output bit width */
+} adc_digi_pattern_config_t;
+
+typedef struct {
+    bool conv_limit_en;                     /*!< Limit ADC conversion times */
+    uint32_t conv_limit_num;                /*!< Conversion limit */
+    uint32_t pattern_num;                   /*!< Number of ADC channels in the pattern table */
+    adc_digi_pattern_config_t* adc_pattern; /*!< Pattern table */
+    uint32_t sample_freq_hz;                /*!< Expected sampling frequency */
+    adc_digi_convert_mode_t conv_mode;      /*!< ADC DMA conversion mode */
+    adc_digi_output_format_t format;        /*!< ADC DMA conversion output format */
+} adc_digi_configuration_t;
+
+typedef struct {
+    uint32_t max_store_buf_size; /*!< Driver buffer size in bytes */
+    uint32_t conv_num_each_intr; /*!< Bytes of conversion data per interrupt */
+    uint32_t adc1_chan_mask;     /*!< Channel list of ADC1 */
+    uint32_t adc2_chan_mask;     /*!< Channel list of ADC2 */
+} adc_digi_init_config_t;
+
+typedef struct {
+    union {
+        struct {
+            uint16_t data : 12;   /*!< ADC real output data */
+            uint16_t channel : 4; /*!< ADC channel index */
+        } type1;
+        uint16_t val;
+    };
+} adc_digi_output_data_t;
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t* init_config);
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t* config);
+esp_err_t adc_digi_start(void);
+esp_err_t adc_digi_stop(void);
+esp_err_t adc_digi_read_bytes(uint8_t* buf, uint32_t length_max, uint32_t* out_length, uint32_t timeout_ms);
+esp_err_t adc_digi_deinitialize(void);
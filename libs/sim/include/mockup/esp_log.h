@@ -1,6 +1,11 @@
 #pragma once
 
+#include <stdarg.h>
+
+typedef int (*vprintf_like_t)(const char*, va_list);
+
 void __log(const char* level, const char* tag, const char* tex, ...);
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
 
 #define ESP_LOGE(tag, text, ...) ESP_LOG("ERR", tag, text, __VA_ARGS__)
 #define ESP_LOGW(tag, text, ...) ESP_LOG("WARN", tag, text, __VA_ARGS__)
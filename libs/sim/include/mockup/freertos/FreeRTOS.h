@@ -24,3 +24,6 @@ typedef int BaseType_t;
 #define pdFAIL (pdFALSE)
 
 #define pdMS_TO_TICKS(tick) (tick)
+
+// ROM busy wait, declared through the port headers on the target
+void ets_delay_us(uint32_t us);
@@ -0,0 +1,161 @@
+//
+// Simulated Signals
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace simulator {
+
+/**
+ * Simulated analog input in the range -1..1 (full ADC scale). Values only
+ * depend on the sample index and time, so the same configuration always
+ * produces the same samples.
+ */
+class Signal {
+   public:
+    virtual ~Signal() = default;
+
+    /**
+     * @brief   Get signal value
+     * @param   index   Conversion index since the ADC was started
+     * @param   t       Time of the conversion in seconds
+     * @return  Value in the range -1..1
+     */
+    virtual double sample(uint64_t index, double t) const = 0;
+};
+
+/**
+ * Generator waveform
+ */
+enum class Waveform {
+    Sine,
+    Square,
+    Triangle,
+    Noise,          // white noise, counter based (reproducible)
+    Chirp,          // linear frequency sweep, repeated
+    Burst           // sine bursts, cycles on and off
+};
+
+/**
+ * Function generator
+ */
+class Generator : public Signal {
+   public:
+    explicit Generator(Waveform waveform = Waveform::Sine, double frequency = 440.0, double amplitude = 0.75);
+
+   public:
+    void setOffset(double offset);
+
+    /**
+     * @brief   Chirp: sweep from the frequency to end_frequency within period seconds
+     */
+    void setChirp(double end_frequency, double period);
+
+    /**
+     * @brief   Burst: cycles_on periods of sine, then cycles_off periods of silence
+     *          (cycles_on is at least 1)
+     */
+    void setBurst(unsigned int cycles_on, unsigned int cycles_off);
+
+    /**
+     * @brief   Add white noise to any waveform
+     */
+    void setNoise(double amplitude, uint32_t seed = 1);
+
+    double sample(uint64_t index, double t) const override;
+
+   private:
+    Waveform waveform_;
+    double frequency_;
+    double amplitude_;
+    double offset_{0.0};
+    double end_frequency_{0.0};
+    double period_{1.0};
+    unsigned int cycles_on_{1};
+    unsigned int cycles_off_{1};
+    double noise_{0.0};
+    uint32_t seed_{1};
+};
+
+/**
+ * Sum of signals
+ */
+class Mix : public Signal {
+   public:
+    void add(std::unique_ptr<Signal> signal);
+    double sample(uint64_t index, double t) const override;
+
+   private:
+    std::vector<std::unique_ptr<Signal>> signals_;
+};
+
+/**
+ * Replay of a recorded signal. The recording has its own sample clock that
+ * is mapped to the conversion time (linear interpolation), so recordings
+ * play at their original speed at any ADC rate.
+ */
+class Recording : public Signal {
+   public:
+    /**
+     * @brief   Load comma separated values in ADC counts (0..4095), lines
+     *          that do not start with a number are skipped
+     * @param   path        File name
+     * @param   sample_rate Samples per second of the recording
+     * @param   column      Column to read
+     * @return  true on success
+     */
+    bool loadCsv(const char* path, double sample_rate, unsigned int column = 0);
+
+    /**
+     * @brief   Load a WAV file (8/16 bit PCM or 32 bit float)
+     * @param   path        File name
+     * @param   channel     Channel to read
+     * @return  true on success
+     */
+    bool loadWav(const char* path, unsigned int channel = 0);
+
+    void setSampleRate(double sample_rate);
+    double getSampleRate() const;
+    void setLoop(bool loop);
+    size_t size() const;
+
+    double sample(uint64_t index, double t) const override;
+
+   private:
+    std::vector<float> samples_;
+    double sample_rate_{0.0};
+    bool loop_{true};
+};
+
+/**
+ * @brief   Create a signal from a text specification:
+ *          sine|square|triangle:<freq>[:<amplitude>], noise[:<amplitude>],
+ *          chirp:<freq>:<end freq>[:<period>], burst:<freq>:<on>:<off>,
+ *          csv:<file>:<rate>[:<column>], wav:<file>[:<channel>]
+ * @return  Signal, nullptr if the specification is invalid
+ */
+std::unique_ptr<Signal> createSignal(const char* spec);
+
+/**
+ * ADC sample clock. Real time follows the system timer, virtual time only
+ * advances with advanceAdcTime(), which makes runs reproducible and lets
+ * benchmarks feed any data rate.
+ */
+enum class AdcClock {
+    RealTime,
+    Virtual
+};
+
+/**
+ * @brief   Set signal of an ADC1 channel, nullptr restores the default
+ *          (a SIM_ADC<channel> environment variable or the built-in tone)
+ */
+void setAdcSignal(int channel, std::shared_ptr<Signal> signal);
+void setAdcClock(AdcClock clock);
+void advanceAdcTime(int64_t us);
+
+}  // namespace simulator
@@ -29,6 +29,7 @@ class Sim {
 
    private:
     void clearDisplay();
+    void saveTrace();
     void updateDisplay();
     void copyDisplayToSurface(SDL_Surface* surface, bool zoom);
 
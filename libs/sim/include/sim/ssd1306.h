@@ -29,9 +29,13 @@ class EmuSSD1306 {
 
    private:
     void alloc();
-    void store(const uint8_t* data, size_t data_size);
+    void store(const uint8_t* data, size_t data_size, int64_t time_ns);
+    int64_t beginTransaction(size_t data_size);
     void trap();
     void scroll();
+    void scan(int64_t time_us);
+    void scanRow(int line);
+    void endPageTransfer();
 
    public:
     bool update();
@@ -42,6 +46,18 @@ class EmuSSD1306 {
     int width() const;
     int height() const;
 
+    /// Bus timing: bytes arrive at the I2C clock rate (9 clocks per byte),
+    /// the bus is busy until getBusIdleTime(). A clock of 0 delivers instantly.
+    void setBusClock(uint32_t frequency);
+    int64_t getBusIdleTime() const;
+
+    /// Panel scan statistics: a page transfer (the bytes written to one page
+    /// up to the next command or page change) is torn if the scan passed
+    /// one of the page's rows while it was written.
+    uint64_t getScannedFrames() const;
+    uint64_t getPageTransfers() const;
+    uint64_t getTornPageTransfers() const;
+
    private:
     graphics::Command last_command_{graphics::Command::None};
     std::vector<uint8_t> command_buffer_;
@@ -57,6 +73,7 @@ class EmuSSD1306 {
     size_t display_memory_size_{0};
 
     uint32_t display_cycle_time_ms_{0};
+    int64_t display_frame_period_us_{0};
     uint8_t display_osc_frequency_{0};
     uint8_t display_clock_divide_ratio_{0};
     uint8_t display_contrast_{0};
@@ -95,6 +112,22 @@ class EmuSSD1306 {
     std::vector<uint8_t> buffer_;
     uint8_t buffer_addr_{0};
 
+    // row scan model: frame_buffer_ holds what the panel shows, rows are
+    // copied from GDDRAM as the scan passes them
+    std::vector<uint8_t> frame_buffer_;
+    int64_t scan_origin_us_{0};
+    int64_t scan_position_{0};      // rows scanned since origin
+
+    uint64_t scanned_frames_{0};
+    uint64_t page_transfers_{0};
+    uint64_t torn_page_transfers_{0};
+    int transfer_page_{-1};         // page of the current transfer, -1 if none
+    int64_t transfer_scan_start_{0};
+    int64_t transfer_scan_end_{0};
+
+    uint32_t bus_clock_hz_{0};
+    int64_t bus_idle_ns_{0};
+
     uint64_t time_offset_{0};
     uint64_t time_next_update_{0};
 
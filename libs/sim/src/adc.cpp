@@ -2,20 +2,85 @@
 // Sim
 //
 #include "driver/adc.h"
+#include "esp_timer.h"
+#include "sim/signal.h"
 
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace simulator;
 
 static int adc1_bits_width = 12;
 static const double PI2 = 3.14159265358979323846 * 2.0;
-static double adc1_counter = 0.0;
 
-int adc1_get_raw(adc1_channel_t channel) {
-    double range = (double)(1 << adc1_bits_width);
-    int value = range * cos(adc1_counter);
-    adc1_counter += 0.1;
-    if (adc1_counter >= PI2) adc1_counter -= PI2;
+// ############################################################################
+// Input signals and clock
+// ############################################################################
+
+// Channels without a signal read a SIM_ADC<channel> environment variable
+// (see createSignal()) once, or fall back to a built-in tone: 440 Hz sine
+// with a weaker third harmonic. Channels later in a scan pattern hear the
+// tone at 1/2, 1/3, ... the frequency.
+
+static const double SIGNAL_FREQUENCY = 440.0;
+
+static std::shared_ptr<Signal> adc_signals[ADC1_CHANNEL_MAX];
+static bool adc_env_checked[ADC1_CHANNEL_MAX] = {};
+static AdcClock adc_clock = AdcClock::RealTime;
+static int64_t adc_virtual_time = 0;
+static uint64_t adc_oneshot_index = 0;
+
+void simulator::setAdcSignal(int channel, std::shared_ptr<Signal> signal) {
+    if (channel < 0 || channel >= ADC1_CHANNEL_MAX) return;
+    adc_signals[channel] = signal;
+    adc_env_checked[channel] = (nullptr != signal);
+}
+
+void simulator::setAdcClock(AdcClock clock) {
+    adc_clock = clock;
+}
+
+void simulator::advanceAdcTime(int64_t us) {
+    adc_virtual_time += us;
+}
 
-    return value;
+static int64_t adcTime() {
+    return (AdcClock::Virtual == adc_clock) ? adc_virtual_time : esp_timer_get_time();
+}
+
+static int signalValue(uint32_t channel, uint32_t slot, uint64_t index, double t) {
+    double v;
+
+    if (channel < ADC1_CHANNEL_MAX && !adc_env_checked[channel]) {
+        adc_env_checked[channel] = true;
+        char name[16];
+        snprintf(name, sizeof(name), "SIM_ADC%u", (unsigned) channel);
+        auto spec = getenv(name);
+        if (nullptr != spec) adc_signals[channel] = createSignal(spec);
+    }
+
+    if (channel < ADC1_CHANNEL_MAX && nullptr != adc_signals[channel]) {
+        v = adc_signals[channel]->sample(index, t);
+    } else {
+        double phase = PI2 * SIGNAL_FREQUENCY / (double) (slot + 1) * t;
+        v = 0.75 * sin(phase) + 0.2 * sin(3.0 * phase);
+    }
+
+    int value = (int) lround(2048.0 + 2047.0 * v);
+    if (value < 0) value = 0;
+    if (value > 4095) value = 4095;
+
+    return value >> (12 - adc1_bits_width);
+}
+
+// ############################################################################
+// One-shot mode
+// ############################################################################
+
+int adc1_get_raw(adc1_channel_t channel) {
+    double t = (double) adcTime() / 1000000.0;
+    return signalValue((uint32_t) channel, 0, adc_oneshot_index++, t);
 }
 
 esp_err_t adc1_config_width(adc_bits_width_t width_bit) {
@@ -37,3 +102,113 @@ esp_err_t adc1_config_width(adc_bits_width_t width_bit) {
 esp_err_t adc1_config_channel_atten(adc1_channel_t channel, adc_atten_t atten) {
     return 0;
 }
+
+// ############################################################################
+// Continuous (DMA) mode
+// ############################################################################
+
+// Conversions happen at the configured rate as the ADC clock advances, the
+// pattern table is scanned round-robin. Samples not read in time are lost,
+// like a DMA buffer overflow.
+
+static bool digi_initialized = false;
+static bool digi_running = false;
+static uint32_t digi_buffer_size = 0;       // bytes
+static const uint32_t MAX_PATTERNS = 16;
+static uint8_t digi_channels[MAX_PATTERNS];
+static uint32_t digi_num_channels = 0;
+static uint32_t digi_sample_rate = 0;
+static int64_t digi_start_time = 0;
+static uint64_t digi_samples_read = 0;
+
+esp_err_t adc_digi_initialize(const adc_digi_init_config_t* init_config) {
+    if (nullptr == init_config || 0 == init_config->adc1_chan_mask) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // without a pattern table, the lowest channel is converted
+    uint32_t channel = 0;
+    while (0 == (init_config->adc1_chan_mask & (1u << channel))) channel++;
+    digi_channels[0] = (uint8_t) channel;
+    digi_num_channels = 1;
+
+    digi_buffer_size = init_config->max_store_buf_size;
+    digi_initialized = true;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_controller_configure(const adc_digi_configuration_t* config) {
+    if (!digi_initialized || nullptr == config || 0 == config->sample_freq_hz) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    digi_sample_rate = config->sample_freq_hz;
+
+    if (nullptr != config->adc_pattern && config->pattern_num > 0) {
+        digi_num_channels = (config->pattern_num < MAX_PATTERNS) ? config->pattern_num : MAX_PATTERNS;
+        for (uint32_t i = 0; i < digi_num_channels; i++) {
+            digi_channels[i] = config->adc_pattern[i].channel;
+        }
+    }
+
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_start(void) {
+    if (!digi_initialized || 0 == digi_sample_rate) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    digi_running = true;
+    digi_start_time = adcTime();
+    digi_samples_read = 0;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_stop(void) {
+    digi_running = false;
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_read_bytes(uint8_t* buf, uint32_t length_max, uint32_t* out_length, uint32_t timeout_ms) {
+    *out_length = 0;
+
+    if (!digi_running) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    uint64_t converted = (uint64_t) ((adcTime() - digi_start_time) * digi_sample_rate / 1000000);
+
+    uint64_t max_pending = digi_buffer_size / sizeof(adc_digi_output_data_t);
+    if (converted - digi_samples_read > max_pending) {
+        digi_samples_read = converted - max_pending;
+    }
+
+    uint64_t count = converted - digi_samples_read;
+    if (count > length_max / sizeof(adc_digi_output_data_t)) {
+        count = length_max / sizeof(adc_digi_output_data_t);
+    }
+
+    if (0 == count) {
+        return ESP_ERR_TIMEOUT;     // the simulator never blocks
+    }
+
+    auto out = (adc_digi_output_data_t*) buf;
+    for (uint64_t i = 0; i < count; i++) {
+        auto index = digi_samples_read + i;
+        auto slot = (uint32_t) (index % digi_num_channels);
+        double t = (double) index / (double) digi_sample_rate;
+        out[i].type1.data = (uint16_t) signalValue(digi_channels[slot], slot, index, t);
+        out[i].type1.channel = digi_channels[slot];
+    }
+
+    digi_samples_read += count;
+    *out_length = (uint32_t) (count * sizeof(adc_digi_output_data_t));
+    return ESP_OK;
+}
+
+esp_err_t adc_digi_deinitialize(void) {
+    digi_running = false;
+    digi_initialized = false;
+    return ESP_OK;
+}
@@ -9,6 +9,7 @@
 #include <thread>
 
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 
 bool app_update();
 
@@ -62,3 +63,32 @@ void vTaskDelayUntil(TickType_t *pxPreviousWakeTime, const TickType_t xTimeIncre
 
     *pxPreviousWakeTime = next_wakeup;
 }
+
+// the simulator runs a single task, a taken mutex can only be taken again
+// recursively, which FreeRTOS mutexes do not allow either
+
+struct __mutex {
+    bool taken{false};
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return new __mutex();
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xTicksToWait) {
+    auto mutex = (__mutex*) xSemaphore;
+    if (nullptr == mutex || mutex->taken) return pdFALSE;
+    mutex->taken = true;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore) {
+    auto mutex = (__mutex*) xSemaphore;
+    if (nullptr == mutex || !mutex->taken) return pdFALSE;
+    mutex->taken = false;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore) {
+    delete (__mutex*) xSemaphore;
+}
@@ -5,6 +5,23 @@
 #include <cstdio>
 #include <stdarg.h>
 
+#include "esp_log.h"
+
+static vprintf_like_t __log_vprintf = &vprintf;
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+    auto previous = __log_vprintf;
+    __log_vprintf = func;
+    return previous;
+}
+
+static void __log_write(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    __log_vprintf(format, args);
+    va_end(args);
+}
+
 void __log(const char* level, const char* tag, const char* format, ...) {
     char buffer[4096];
     va_list args;
@@ -12,5 +29,5 @@ void __log(const char* level, const char* tag, const char* format, ...) {
     vsnprintf(buffer, 4096, format, args);
     va_end (args);
 
-    printf("%s %s: %s\n", level, tag, buffer);
+    __log_write("%s %s: %s\n", level, tag, buffer);
 }
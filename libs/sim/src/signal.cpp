@@ -0,0 +1,314 @@
+//
+// Simulated Signals
+//
+
+#include "sim/signal.h"
+
+#include "esp_log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#define TAG "signal"
+
+using namespace simulator;
+
+static const double PI2 = 3.14159265358979323846 * 2.0;
+
+// uniform -1..1 from a counter (splitmix64), independent of the read pattern
+static double noiseValue(uint64_t index, uint32_t seed) {
+    uint64_t z = index + ((uint64_t) seed << 32) + 0x9e3779b97f4a7c15ull;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    z = z ^ (z >> 31);
+    return (double) (z >> 11) / (double) (1ull << 52) - 1.0;
+}
+
+// ############################################################################
+// Generator
+// ############################################################################
+
+Generator::Generator(Waveform waveform, double frequency, double amplitude)
+    : waveform_(waveform), frequency_(frequency), amplitude_(amplitude), end_frequency_(frequency) {}
+
+void Generator::setOffset(double offset) {
+    offset_ = offset;
+}
+
+void Generator::setChirp(double end_frequency, double period) {
+    end_frequency_ = end_frequency;
+    period_ = (period > 0.0) ? period : 1.0;
+}
+
+void Generator::setBurst(unsigned int cycles_on, unsigned int cycles_off) {
+    // at least one cycle on, a burst period of zero is undefined
+    cycles_on_ = (cycles_on > 0) ? cycles_on : 1;
+    cycles_off_ = cycles_off;
+}
+
+void Generator::setNoise(double amplitude, uint32_t seed) {
+    noise_ = amplitude;
+    seed_ = seed;
+}
+
+double Generator::sample(uint64_t index, double t) const {
+    double cycles = frequency_ * t;
+    double fraction = cycles - floor(cycles);
+    double v = 0.0;
+
+    switch (waveform_) {
+        case Waveform::Sine:
+            v = sin(PI2 * fraction);
+            break;
+        case Waveform::Square:
+            v = (fraction < 0.5) ? 1.0 : -1.0;
+            break;
+        case Waveform::Triangle:
+            v = (fraction < 0.5) ? 4.0 * fraction - 1.0 : 3.0 - 4.0 * fraction;
+            break;
+        case Waveform::Noise:
+            v = noiseValue(index, seed_ + 1);
+            break;
+        case Waveform::Chirp: {
+            double tau = fmod(t, period_);
+            double phase = frequency_ * tau + (end_frequency_ - frequency_) * tau * tau / (2.0 * period_);
+            v = sin(PI2 * (phase - floor(phase)));
+            break;
+        }
+        case Waveform::Burst: {
+            auto cycle = (uint64_t) cycles;
+            bool on = (cycle % (cycles_on_ + cycles_off_)) < cycles_on_;
+            v = on ? sin(PI2 * fraction) : 0.0;
+            break;
+        }
+    }
+
+    v = offset_ + amplitude_ * v;
+    if (noise_ > 0.0) {
+        v += noise_ * noiseValue(index, seed_);
+    }
+
+    return v;
+}
+
+// ############################################################################
+// Mix
+// ############################################################################
+
+void Mix::add(std::unique_ptr<Signal> signal) {
+    if (nullptr != signal) {
+        signals_.push_back(std::move(signal));
+    }
+}
+
+double Mix::sample(uint64_t index, double t) const {
+    double v = 0.0;
+    for (const auto& signal : signals_) {
+        v += signal->sample(index, t);
+    }
+    return v;
+}
+
+// ############################################################################
+// Recording
+// ############################################################################
+
+bool Recording::loadCsv(const char* path, double sample_rate, unsigned int column) {
+    auto file = fopen(path, "r");
+    if (nullptr == file) {
+        ESP_LOGE(TAG, "failed to open %s", path);
+        return false;
+    }
+
+    samples_.clear();
+
+    char line[512];
+    while (nullptr != fgets(line, sizeof(line), file)) {
+        const char* p = line;
+        for (unsigned int i = 0; i < column && nullptr != p; i++) {
+            p = strchr(p, ',');
+            if (nullptr != p) p++;
+        }
+        if (nullptr == p) continue;
+
+        char* end = nullptr;
+        double value = strtod(p, &end);
+        if (end == p) continue;                 // header or empty line
+
+        samples_.push_back((float) ((value - 2048.0) / 2047.0));
+    }
+
+    fclose(file);
+
+    sample_rate_ = sample_rate;
+    ESP_LOGI(TAG, "loaded %u samples from %s", (unsigned) samples_.size(), path);
+    return !samples_.empty() && sample_rate_ > 0.0;
+}
+
+bool Recording::loadWav(const char* path, unsigned int channel) {
+    auto file = fopen(path, "rb");
+    if (nullptr == file) {
+        ESP_LOGE(TAG, "failed to open %s", path);
+        return false;
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[4096];
+    size_t count;
+    while (0 != (count = fread(buffer, 1, sizeof(buffer), file))) {
+        data.insert(data.end(), buffer, buffer + count);
+    }
+    fclose(file);
+
+    auto u16 = [&](size_t ofs) { return (uint32_t) data[ofs] | ((uint32_t) data[ofs + 1] << 8); };
+    auto u32 = [&](size_t ofs) { return u16(ofs) | (u16(ofs + 2) << 16); };
+
+    if (data.size() < 12 || 0 != memcmp(&data[0], "RIFF", 4) || 0 != memcmp(&data[8], "WAVE", 4)) {
+        ESP_LOGE(TAG, "%s: not a WAV file", path);
+        return false;
+    }
+
+    uint32_t format = 0, channels = 0, rate = 0, bits = 0;
+    size_t data_ofs = 0, data_size = 0;
+
+    for (size_t ofs = 12; ofs + 8 <= data.size();) {
+        auto size = (size_t) u32(ofs + 4);
+        if (0 == memcmp(&data[ofs], "fmt ", 4) && size >= 16 && ofs + 8 + 16 <= data.size()) {
+            format = u16(ofs + 8);
+            channels = u16(ofs + 10);
+            rate = u32(ofs + 12);
+            bits = u16(ofs + 22);
+        } else if (0 == memcmp(&data[ofs], "data", 4)) {
+            data_ofs = ofs + 8;
+            data_size = std::min(size, data.size() - data_ofs);
+        }
+        ofs += 8 + size + (size & 1);
+    }
+
+    bool pcm = (1 == format && (8 == bits || 16 == bits));
+    bool pcm_float = (3 == format && 32 == bits);
+    if ((!pcm && !pcm_float) || 0 == channels || channel >= channels || 0 == rate || 0 == data_size) {
+        ESP_LOGE(TAG, "%s: unsupported format", path);
+        return false;
+    }
+
+    samples_.clear();
+
+    size_t frame_size = channels * bits / 8;
+    for (size_t ofs = data_ofs + channel * bits / 8; ofs + bits / 8 <= data_ofs + data_size; ofs += frame_size) {
+        float value;
+        if (8 == bits) {
+            value = ((float) data[ofs] - 128.0f) / 128.0f;
+        } else if (16 == bits) {
+            value = (float) (int16_t) u16(ofs) / 32768.0f;
+        } else {
+            uint32_t raw = u32(ofs);
+            memcpy(&value, &raw, sizeof(value));
+        }
+        samples_.push_back(value);
+    }
+
+    sample_rate_ = rate;
+    ESP_LOGI(TAG, "loaded %u samples at %u Hz from %s", (unsigned) samples_.size(), (unsigned) rate, path);
+    return !samples_.empty();
+}
+
+void Recording::setSampleRate(double sample_rate) {
+    sample_rate_ = sample_rate;
+}
+
+double Recording::getSampleRate() const {
+    return sample_rate_;
+}
+
+void Recording::setLoop(bool loop) {
+    loop_ = loop;
+}
+
+size_t Recording::size() const {
+    return samples_.size();
+}
+
+double Recording::sample(uint64_t /*index*/, double t) const {
+    if (samples_.empty() || sample_rate_ <= 0.0) {
+        return 0.0;
+    }
+
+    double position = t * sample_rate_;
+    auto size = samples_.size();
+    auto i = (uint64_t) position;
+    double fraction = position - (double) i;
+
+    if (!loop_ && i + 1 >= size) {
+        return samples_[size - 1];
+    }
+
+    double a = samples_[i % size];
+    double b = samples_[(i + 1) % size];
+    return a + (b - a) * fraction;
+}
+
+// ############################################################################
+// Specification
+// ############################################################################
+
+std::unique_ptr<Signal> simulator::createSignal(const char* spec) {
+    if (nullptr == spec) return nullptr;
+
+    // split "name:arg:arg..."
+    std::vector<std::string> args;
+    std::string text(spec);
+    size_t start = 0;
+    while (true) {
+        auto pos = text.find(':', start);
+        args.push_back(text.substr(start, pos - start));
+        if (std::string::npos == pos) break;
+        start = pos + 1;
+    }
+
+    // keep drive letters of file names ("wav:C:\\data\\test.wav")
+    if (args.size() > 2 && 1 == args[1].size() && !args[2].empty() && ('\\' == args[2][0] || '/' == args[2][0])) {
+        args[1] += ":" + args[2];
+        args.erase(args.begin() + 2);
+    }
+
+    const auto& name = args[0];
+    auto number = [&](size_t i, double def) { return (i < args.size() && !args[i].empty()) ? atof(args[i].c_str()) : def; };
+
+    if ("sine" == name || "square" == name || "triangle" == name) {
+        auto waveform = ("sine" == name) ? Waveform::Sine : ("square" == name) ? Waveform::Square : Waveform::Triangle;
+        return std::unique_ptr<Signal>(new Generator(waveform, number(1, 440.0), number(2, 0.75)));
+    }
+
+    if ("noise" == name) {
+        return std::unique_ptr<Signal>(new Generator(Waveform::Noise, 0.0, number(1, 0.5)));
+    }
+
+    if ("chirp" == name) {
+        auto generator = new Generator(Waveform::Chirp, number(1, 100.0), 0.75);
+        generator->setChirp(number(2, 5000.0), number(3, 1.0));
+        return std::unique_ptr<Signal>(generator);
+    }
+
+    if ("burst" == name) {
+        auto generator = new Generator(Waveform::Burst, number(1, 1000.0), 0.75);
+        generator->setBurst((unsigned int) number(2, 5.0), (unsigned int) number(3, 20.0));
+        return std::unique_ptr<Signal>(generator);
+    }
+
+    if (("csv" == name || "wav" == name) && args.size() >= 2) {
+        auto recording = std::unique_ptr<Recording>(new Recording());
+        bool result = ("csv" == name)
+            ? recording->loadCsv(args[1].c_str(), number(2, 20000.0), (unsigned int) number(3, 0.0))
+            : recording->loadWav(args[1].c_str(), (unsigned int) number(2, 0.0));
+        if (result) return recording;
+        return nullptr;
+    }
+
+    ESP_LOGE(TAG, "invalid signal: %s", spec);
+    return nullptr;
+}
@@ -6,6 +6,7 @@
 
 #include "application/application.h"
 #include "sim/ssd1306.h"
+#include "sys/trace.h"
 
 #include <chrono>
 #include <thread>
@@ -107,8 +108,12 @@ bool Sim::update() {
 
     while( SDL_PollEvent( &e ) != 0 ) {
         if(e.type == SDL_QUIT) {
+            saveTrace();
             return false;
         }
+        if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_t) {
+            saveTrace();
+        }
     }
 
     if (!running_ || error_) {
@@ -138,7 +143,10 @@ bool Sim::update() {
             fps_counter_ = 0;
             fps_time_ = now;
 
-            printf("INFO sim: frames/sec: %d\n", fps_);
+            printf("INFO sim: frames/sec: %d, panel frames: %d, torn page transfers: %d/%d\n", fps_,
+                   (int) display_emu_->getScannedFrames(),
+                   (int) display_emu_->getTornPageTransfers(),
+                   (int) display_emu_->getPageTransfers());
         }
 
     }
@@ -146,6 +154,13 @@ bool Sim::update() {
     return true;
 }
 
+void Sim::saveTrace() {
+#ifdef TRACE_ENABLED
+    // open in chrome://tracing or ui.perfetto.dev
+    sys::Trace::save("trace.json");
+#endif
+}
+
 void Sim::clearDisplay() {
     if (nullptr == window_ || nullptr == screen_surface_) {
         return;
@@ -3,7 +3,9 @@
 //
 
 #include "sim/ssd1306.h"
+#include "esp_timer.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <chrono>
 
@@ -31,6 +33,7 @@ void EmuSSD1306::reset() {
     display_osc_frequency_ = 0x8;
     display_clock_divide_ratio_ = 0x0;
     display_cycle_time_ms_ = 57;
+    display_frame_period_us_ = display_cycle_time_ms_ * 1000;
 
     display_start_line_ = 0x0;
 
@@ -59,6 +62,13 @@ void EmuSSD1306::reset() {
     display_scroll_frame_counter_ = 0;
     display_scroll_vertical_offset_ = 0;
 
+    scan_origin_us_ = 0;
+    scan_position_ = 0;
+    scanned_frames_ = 0;
+    page_transfers_ = 0;
+    torn_page_transfers_ = 0;
+    transfer_page_ = -1;
+
     alloc();
 }
 
@@ -66,6 +76,7 @@ void EmuSSD1306::alloc() {
     size_t buffer_size = display_height_ * display_width_ / 8;
     buffer_.resize(buffer_size, 0x0);
     buffer_addr_ = 0x0;
+    frame_buffer_.resize(buffer_size, 0x0);
 
     command_buffer_.resize(1024, 0x0);
     command_buffer_usage_ = 0x0;
@@ -91,6 +102,9 @@ void EmuSSD1306::clearCommandData() {
 
 void EmuSSD1306::onCommand(const uint8_t* data, size_t data_size) {
 
+    beginTransaction(data_size);
+    endPageTransfer();
+
     if (nullptr == data) {
         clearCommandData();
         last_command_ = Command::None;
@@ -155,6 +169,10 @@ void EmuSSD1306::onCommand(const uint8_t* data, size_t data_size) {
                         display_on_ = false;
                         break;
                     case Command::SetDisplayOn:
+                        if (!display_on_) {
+                            scan_origin_us_ = esp_timer_get_time();
+                            scan_position_ = 0;
+                        }
                         display_on_ = true;
                         break;
                     case Command::SetDisplayClockDivider:
@@ -280,6 +298,7 @@ void EmuSSD1306::onCommand(const uint8_t* data, size_t data_size) {
                         float frequency = osc_frequency_value / (float)(clock_ticks_per_frame);
                         float cycle_time = (frequency != 0.0f) ? 1.0f / frequency : 0.0f;
                         display_cycle_time_ms_ = (uint32_t) (1000.0 * cycle_time);
+                        display_frame_period_us_ = (int64_t) (1000000.0 * cycle_time);
                         break;
                     }
                     default:
@@ -297,24 +316,60 @@ void EmuSSD1306::onCommand(const uint8_t* data, size_t data_size) {
 }
 
 void EmuSSD1306::onData(const uint8_t* data, size_t data_size) {
+    int64_t time_ns = beginTransaction(data_size);
+
     if (Command::SetColumnAddress == last_command_ ||
         Command::SetPageAddress == last_command_) {
         // printf("I2C: store data (%d data bytes)\n", (int) data_size);
-        store(data, data_size);
+        store(data, data_size, time_ns);
     } else {
         printf("I2C: handle data (%d data bytes)\n", (int)data_size);
-        store(data, data_size);
+        store(data, data_size, time_ns);
     }
 }
 
+void EmuSSD1306::setBusClock(uint32_t frequency) {
+    bus_clock_hz_ = frequency;
+}
+
+int64_t EmuSSD1306::getBusIdleTime() const {
+    return bus_idle_ns_ / 1000;
+}
+
+int64_t EmuSSD1306::beginTransaction(size_t data_size) {
+
+    // address and control byte go first, each byte takes 8 bits plus ack.
+    // Returns the time the first data byte has been received.
+
+    int64_t start_ns = std::max(esp_timer_get_time() * 1000, bus_idle_ns_);
+    int64_t byte_ns = (bus_clock_hz_ > 0) ? 9000000000LL / bus_clock_hz_ : 0;
+
+    bus_idle_ns_ = start_ns + (int64_t) (data_size + 2) * byte_ns;
+
+    return start_ns + 3 * byte_ns;
+}
+
 void EmuSSD1306::trap() {
     display_fault_ = true;
 }
 
-void EmuSSD1306::store(const uint8_t* data, size_t data_size) {
+void EmuSSD1306::store(const uint8_t* data, size_t data_size, int64_t time_ns) {
+    int64_t byte_ns = (bus_clock_hz_ > 0) ? 9000000000LL / bus_clock_hz_ : 0;
+
     for (auto i = 0; i < data_size; i++) {
+
+        // rows scanned before the byte arrives still show the old data
+        scan((time_ns + i * byte_ns) / 1000);
+
+        if (display_page_addr_ != transfer_page_) {
+            endPageTransfer();
+            transfer_page_ = display_page_addr_;
+            transfer_scan_start_ = scan_position_;
+        }
+
         size_t ofs = display_page_addr_ * display_page_size_ + display_column_addr_;
         buffer_[ofs] = *(data++);
+        transfer_scan_end_ = scan_position_;
 
         if (0x0 == display_page_addr_mode_) {  // Horizontal addressing mode
             display_column_addr_++;
@@ -371,7 +426,7 @@ bool EmuSSD1306::getPixel(int x, int y) const {
     }
 
     size_t ofs = x + (y / 8) * display_width_;
-    uint8_t segment = buffer_.at(ofs);
+    uint8_t segment = frame_buffer_.at(ofs);
     bool pixel = (0x0 != (segment & (1 << (y & 7))));
 
     return pixel;
@@ -400,6 +455,8 @@ bool EmuSSD1306::update() {
         scroll();
     }
 
+    scan(esp_timer_get_time());
+
     return true;
 }
 
@@ -407,6 +464,80 @@ uint32_t EmuSSD1306::getCycleTimeMs() const {
     return display_cycle_time_ms_;
 }
 
+uint64_t EmuSSD1306::getScannedFrames() const {
+    return scanned_frames_;
+}
+
+uint64_t EmuSSD1306::getPageTransfers() const {
+    return page_transfers_;
+}
+
+uint64_t EmuSSD1306::getTornPageTransfers() const {
+    return torn_page_transfers_;
+}
+
+void EmuSSD1306::scan(int64_t time_us) {
+    if (!display_on_ || display_frame_period_us_ <= 0) {
+        return;
+    }
+
+    int64_t target = (time_us - scan_origin_us_) * display_height_ / display_frame_period_us_;
+    if (target - scan_position_ > display_height_) {
+        // skip frames nobody could observe
+        scanned_frames_ += (target - scan_position_) / display_height_ - 1;
+        scan_position_ = target - display_height_;
+    }
+
+    while (scan_position_ < target) {
+        int step = (int) (scan_position_ % display_height_);
+        scanRow(step);
+        scan_position_++;
+        if (0 == scan_position_ % display_height_) {
+            scanned_frames_++;
+        }
+    }
+}
+
+void EmuSSD1306::scanRow(int line) {
+
+    // panel line shows the RAM row selected by the display start line
+
+    int row = (display_start_line_ + line) % display_height_;
+
+    size_t src_ofs = (row / 8) * display_page_size_;
+    int src_shift = row & 7;
+
+    size_t dest_ofs = (line / 8) * display_page_size_;
+    uint8_t mask = (uint8_t) (1 << (line & 7));
+
+    for (size_t col = 0; col < display_page_size_; col++) {
+        uint8_t pixel = (uint8_t) (((buffer_[src_ofs + col] >> src_shift) & 0x1) << (line & 7));
+        frame_buffer_[dest_ofs + col] = (frame_buffer_[dest_ofs + col] & ~mask) | pixel;
+    }
+}
+
+void EmuSSD1306::endPageTransfer() {
+    if (transfer_page_ < 0) {
+        return;
+    }
+
+    // the page is torn if the scan passed one of its rows between the
+    // first and the last byte written to it
+
+    bool torn = (transfer_scan_end_ - transfer_scan_start_ >= display_height_);
+
+    for (int64_t position = transfer_scan_start_; !torn && position < transfer_scan_end_; position++) {
+        int line = (int) (position % display_height_);
+        int row = (display_start_line_ + line) % display_height_;
+        torn = (row / 8 == transfer_page_);
+    }
+
+    page_transfers_++;
+    if (torn) torn_page_transfers_++;
+
+    transfer_page_ = -1;
+}
+
 void EmuSSD1306::scroll() {
 
     uint32_t scroll_interval = SCROLL_FRAME_INTERVAL[display_scroll_time_intervall_];
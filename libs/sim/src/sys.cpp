@@ -6,9 +6,13 @@
 #include "sim/ssd1306.h"
 
 #include "driver/i2c.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
 
 #include <cassert>
 #include <cstdint>
+#include <cstdlib>
 
 extern EmuSSD1306 emu1306;
 
@@ -30,8 +34,24 @@ void esp_restart(void) {
     }
 }
 
+// the simulator has a single heap, capabilities are ignored
+
+void* heap_caps_malloc(size_t size, uint32_t caps) {
+    return malloc(size);
+}
+
+void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
 esp_err_t i2c_param_config(i2c_port_t i2c_num, const i2c_config_t *i2c_conf) {
     i2c_port = i2c_num;
+
+    auto sim = simulator::Sim::instance();
+    if (nullptr != sim && nullptr != i2c_conf) {
+        sim->getDisplayDevice()->setBusClock(i2c_conf->master.clk_speed);
+    }
+
     return ESP_OK;
 }
 
@@ -122,5 +142,13 @@ esp_err_t i2c_master_cmd_begin(i2c_port_t i2c_num, i2c_cmd_handle_t cmd_handle,
     if (i2c_num != i2c_port || nullptr == cmd_handle) {
         return ESP_FAIL;
     }
+
+    // the command has been delivered in i2c_master_stop(), block until
+    // the emulated bus has sent it like the driver does
+    auto wait_us = simulator::Sim::instance()->getDisplayDevice()->getBusIdleTime() - esp_timer_get_time();
+    if (wait_us > 0) {
+        ets_delay_us((uint32_t) wait_us);
+    }
+
     return ESP_OK;
 }
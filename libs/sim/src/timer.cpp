@@ -0,0 +1,22 @@
+//
+// Sim
+//
+
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+
+#include <chrono>
+
+static const auto timer_start = std::chrono::steady_clock::now();
+
+int64_t esp_timer_get_time(void) {
+    auto elapsed = std::chrono::steady_clock::now() - timer_start;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void ets_delay_us(uint32_t us) {
+    auto until = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+    while (std::chrono::steady_clock::now() < until) {
+        // busy wait
+    }
+}
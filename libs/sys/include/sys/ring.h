@@ -0,0 +1,111 @@
+//
+// Ring Buffer
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sys {
+
+/**
+ * Lock-free single producer / single consumer ring buffer.
+ * One task may push, one other task (or ISR) may pop. Capacity must be a
+ * power of two. Values pushed into a full ring are dropped and counted.
+ */
+template <typename T, size_t N>
+class RingBuffer {
+    static_assert(N > 0 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+    public:
+        RingBuffer() = default;
+
+    public: // Producer
+        bool push(const T& value) {
+            auto head = head_.load(std::memory_order_relaxed);
+            auto tail = tail_.load(std::memory_order_acquire);
+            if (head - tail >= N) {
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            buffer_[head & (N - 1)] = value;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t push(const T* values, size_t count) {
+            auto head = head_.load(std::memory_order_relaxed);
+            auto tail = tail_.load(std::memory_order_acquire);
+            auto space = N - (size_t) (head - tail);
+            auto n = (count < space) ? count : space;
+
+            for (size_t i = 0; i < n; i++) {
+                buffer_[(head + i) & (N - 1)] = values[i];
+            }
+
+            head_.store(head + (uint32_t) n, std::memory_order_release);
+
+            if (n < count) {
+                dropped_.fetch_add((uint32_t) (count - n), std::memory_order_relaxed);
+            }
+
+            return n;
+        }
+
+    public: // Consumer
+        bool pop(T& value) {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            auto head = head_.load(std::memory_order_acquire);
+            if (head == tail) {
+                return false;
+            }
+
+            value = buffer_[tail & (N - 1)];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        size_t pop(T* values, size_t max_count) {
+            auto tail = tail_.load(std::memory_order_relaxed);
+            auto head = head_.load(std::memory_order_acquire);
+            auto available = (size_t) (head - tail);
+            auto n = (max_count < available) ? max_count : available;
+
+            for (size_t i = 0; i < n; i++) {
+                values[i] = buffer_[(tail + i) & (N - 1)];
+            }
+
+            tail_.store(tail + (uint32_t) n, std::memory_order_release);
+            return n;
+        }
+
+        /**
+         * @brief   Drop all buffered values (consumer side)
+         */
+        void clear() {
+            tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release);
+        }
+
+    public:
+        size_t size() const {
+            return (size_t) (head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+        }
+
+        bool empty() const { return 0 == size(); }
+        static constexpr size_t capacity() { return N; }
+        uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        T buffer_[N];
+        std::atomic<uint32_t> head_{0};     // values written (producer)
+        std::atomic<uint32_t> tail_{0};     // values read (consumer)
+        std::atomic<uint32_t> dropped_{0};
+
+    public:
+        RingBuffer(const RingBuffer&) = delete;
+        RingBuffer& operator=(const RingBuffer&) = delete;
+};
+
+}  // namespace sys
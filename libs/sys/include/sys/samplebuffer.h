@@ -0,0 +1,113 @@
+//
+// Sample Buffer
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sys {
+
+/**
+ * Storage format of 12 bit samples
+ */
+enum class SampleFormat {
+    Int16,          // 2 bytes per sample
+    Packed12        // 3 bytes per 2 samples
+};
+
+/**
+ * Memory a sample buffer is allocated from
+ */
+enum class MemorySource {
+    Internal,       // internal RAM
+    External,       // PSRAM (SPI RAM)
+    Static          // caller provided arena
+};
+
+/**
+ * Fixed capacity storage of 12 bit samples with a selectable format and
+ * memory source. Large captures fit into PSRAM or a static arena instead of
+ * competing with the heap for internal RAM.
+ */
+class SampleBuffer {
+    public:
+        SampleBuffer();
+        ~SampleBuffer();
+
+    public:
+        /**
+         * @brief   Allocate the buffer from the heap
+         * @param   capacity    Number of samples
+         * @param   format      Storage format
+         * @param   source      Internal or External memory
+         * @return  true on success
+         */
+        bool allocate(size_t capacity, SampleFormat format, MemorySource source);
+
+        /**
+         * @brief   Use a caller provided arena, the capacity follows from its size
+         * @param   arena       Memory, must outlive the buffer
+         * @param   size        Size of the arena in bytes
+         * @param   format      Storage format
+         * @return  true on success
+         */
+        bool attach(void* arena, size_t size, SampleFormat format);
+
+        /**
+         * @brief   Free or detach the memory
+         */
+        void release();
+
+        static size_t bytesRequired(size_t capacity, SampleFormat format);
+
+    public:
+        inline void set(size_t index, uint16_t value) {
+            if (SampleFormat::Int16 == format_) {
+                ((uint16_t*) data_)[index] = value;
+                return;
+            }
+
+            // two samples share three bytes: low bytes first, high nibbles in the third byte
+            auto p = data_ + (index >> 1) * 3;
+            if (index & 1) {
+                p[1] = (uint8_t) value;
+                p[2] = (uint8_t) ((p[2] & 0x0f) | ((value >> 4) & 0xf0));
+            } else {
+                p[0] = (uint8_t) value;
+                p[2] = (uint8_t) ((p[2] & 0xf0) | ((value >> 8) & 0x0f));
+            }
+        }
+
+        inline uint16_t get(size_t index) const {
+            if (SampleFormat::Int16 == format_) {
+                return ((const uint16_t*) data_)[index];
+            }
+
+            auto p = data_ + (index >> 1) * 3;
+            if (index & 1) {
+                return (uint16_t) (p[1] | ((p[2] & 0xf0) << 4));
+            }
+            return (uint16_t) (p[0] | ((p[2] & 0x0f) << 8));
+        }
+
+        size_t capacity() const;
+        size_t bytes() const;
+        SampleFormat format() const;
+        MemorySource source() const;
+
+    private:
+        uint8_t* data_{nullptr};
+        size_t capacity_{0};
+        size_t bytes_{0};
+        SampleFormat format_{SampleFormat::Int16};
+        MemorySource source_{MemorySource::Internal};
+
+    public:
+        SampleBuffer(const SampleBuffer&) = delete;
+        SampleBuffer(const SampleBuffer&&) = delete;
+        SampleBuffer& operator=(const SampleBuffer&) = delete;
+        SampleBuffer& operator=(const SampleBuffer&&) = delete;
+};
+
+}  // namespace sys
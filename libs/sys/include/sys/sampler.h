@@ -0,0 +1,95 @@
+//
+// ADC Sampler
+//
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "driver/adc.h"
+#include "sys/ring.h"
+
+namespace sys {
+
+/**
+ * Background ADC sampling. The ADC runs in continuous (DMA) mode, a
+ * sampler task moves completed DMA blocks into a lock-free ring, and the
+ * render loop drains the ring once per frame. The sample rate is
+ * independent of the frame rate. Several channels are scanned round-robin
+ * and delivered as interleaved frames of one sample per channel.
+ *
+ * In the simulator there is no sampler task, read() polls the driver.
+ */
+class AdcSampler {
+    public:
+        static const size_t RING_SIZE = 4096;       // samples
+        static const size_t BLOCK_SIZE = 256;       // samples per DMA transfer
+        static const size_t MAX_CHANNELS = 8;
+
+    public:
+        AdcSampler();
+        ~AdcSampler();
+
+    public:
+        /**
+         * @brief   Start sampling
+         * @param   channel     ADC1 channel
+         * @param   sample_rate Samples per second (ESP32: 20 kHz to 2 MHz)
+         * @return  true on success
+         */
+        bool start(adc1_channel_t channel, uint32_t sample_rate);
+
+        /**
+         * @brief   Start sampling several channels, scanned round-robin
+         * @param   channels    ADC1 channels in frame order
+         * @param   count       Number of channels
+         * @param   sample_rate Frames per second, the ADC converts count times
+         *                      as many samples (ESP32: 20 kHz to 2 MHz in total)
+         * @return  true on success
+         */
+        bool start(const adc1_channel_t* channels, size_t count, uint32_t sample_rate);
+
+        /**
+         * @brief   Stop sampling
+         */
+        void stop();
+
+        /**
+         * @brief   Read buffered samples (consumer side), whole frames only
+         * @param   samples     Destination buffer
+         * @param   max_count   Maximum number of samples
+         * @return  Number of samples read (a multiple of the channel count)
+         */
+        size_t read(uint16_t* samples, size_t max_count);
+
+        size_t available() const;
+        size_t channels() const;
+        uint32_t sampleRate() const;    // frames per second
+        uint32_t dropped() const;       // samples lost to a full ring
+
+    private:
+        static void taskEntry(void* arg);
+        size_t poll(uint32_t timeout_ms);
+
+    private:
+        RingBuffer<uint16_t, RING_SIZE> ring_;
+        adc1_channel_t channels_[MAX_CHANNELS];
+        size_t num_channels_{0};
+        uint8_t slots_[16];             // frame position per channel number
+        uint16_t frame_[MAX_CHANNELS];  // frame being assembled
+        size_t frame_pos_{0};
+        volatile uint32_t dropped_{0};
+        uint32_t sample_rate_{0};
+        volatile bool running_{false};
+        void* volatile task_{nullptr};
+        adc_digi_output_data_t block_[BLOCK_SIZE];
+        uint16_t values_[BLOCK_SIZE];
+
+    public:
+        AdcSampler(const AdcSampler&) = delete;
+        AdcSampler(const AdcSampler&&) = delete;
+        AdcSampler& operator=(const AdcSampler&) = delete;
+        AdcSampler& operator=(const AdcSampler&&) = delete;
+};
+
+}  // namespace sys
@@ -0,0 +1,94 @@
+//
+// Trace
+//
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+/*
+    Scoped trace markers for hot paths. Compiled out unless TRACE_ENABLED is defined.
+
+        void Display::refresh() {
+            TRACE_SCOPE("display.refresh");
+            ...
+        }
+
+    Names must be string literals (or otherwise outlive the trace).
+*/
+
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 1024      ///< events per task ring buffer
+#endif
+
+#ifndef TRACE_MAX_TASKS
+#define TRACE_MAX_TASKS 4           ///< number of tasks which can record events
+#endif
+
+#define __TRACE_CONCAT2(a, b) a##b
+#define __TRACE_CONCAT(a, b) __TRACE_CONCAT2(a, b)
+
+#ifdef TRACE_ENABLED
+#define TRACE_SCOPE(name) sys::TraceScope __TRACE_CONCAT(__trace_scope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void) 0)
+#endif
+
+namespace sys {
+
+/**
+ * Complete trace event (begin timestamp and duration)
+ */
+struct TraceEvent {
+    const char* name;
+    int64_t start_us;
+    uint32_t duration_us;
+};
+
+/**
+ * Per-task event ring buffer. Single writer (the owning task),
+ * readers see the last TRACE_BUFFER_SIZE events.
+ */
+struct TraceBuffer {
+    TraceEvent events[TRACE_BUFFER_SIZE];
+    std::atomic<uint32_t> head{0};  ///< number of events written
+    int task_id{0};
+};
+
+/**
+ * Trace recording and export
+ */
+class Trace {
+    public:
+        static int64_t now();
+        static void record(const char* name, int64_t start_us, uint32_t duration_us);
+        static void clear();
+
+    public:
+        static bool dump(FILE* file);
+        static bool save(const char* filename);
+
+    private:
+        static TraceBuffer* buffer();
+};
+
+/**
+ * Records the lifetime of a scope as trace event
+ */
+class TraceScope {
+    public:
+        explicit TraceScope(const char* name) : name_(name), start_us_(Trace::now()) {}
+        ~TraceScope() { Trace::record(name_, start_us_, (uint32_t) (Trace::now() - start_us_)); }
+
+    private:
+        const char* name_;
+        int64_t start_us_;
+
+    public:
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+};
+
+}  // namespace sys
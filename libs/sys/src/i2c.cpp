@@ -3,6 +3,7 @@
 //
 
 #include "sys/i2c.h"
+#include "sys/trace.h"
 
 #include "esp_log.h"
 #include "esp_intr_alloc.h"
@@ -75,6 +76,8 @@ bool I2C::sendBufferRaw(const uint8_t* buffer, size_t buffer_size, int flags) {
         return false;
     }
 
+    TRACE_SCOPE("i2c.transfer");
+
     size_t k = 0;
 
     size_t max_bytes = I2C::IC2_MAX_LIST_LEN-1;  // max = sz - address byte
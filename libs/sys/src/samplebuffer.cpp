@@ -0,0 +1,93 @@
+//
+// Sample Buffer
+//
+
+#include "sys/samplebuffer.h"
+
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+#include <cstring>
+
+#define TAG "samples"
+
+using namespace sys;
+
+SampleBuffer::SampleBuffer() {}
+
+SampleBuffer::~SampleBuffer() {
+    release();
+}
+
+size_t SampleBuffer::bytesRequired(size_t capacity, SampleFormat format) {
+    return (SampleFormat::Int16 == format) ? capacity * 2 : (capacity + 1) / 2 * 3;
+}
+
+bool SampleBuffer::allocate(size_t capacity, SampleFormat format, MemorySource source) {
+    release();
+
+    if (0 == capacity || MemorySource::Static == source) {
+        return false;
+    }
+
+    auto bytes = bytesRequired(capacity, format);
+    uint32_t caps = (MemorySource::External == source) ? MALLOC_CAP_SPIRAM : (MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+
+    data_ = (uint8_t*) heap_caps_malloc(bytes, caps);
+    if (nullptr == data_) {
+        ESP_LOGE(TAG, "failed to allocate %u bytes", (unsigned) bytes);
+        return false;
+    }
+
+    memset(data_, 0, bytes);
+    capacity_ = capacity;
+    bytes_ = bytes;
+    format_ = format;
+    source_ = source;
+
+    return true;
+}
+
+bool SampleBuffer::attach(void* arena, size_t size, SampleFormat format) {
+    release();
+
+    size_t capacity = (SampleFormat::Int16 == format) ? size / 2 : size / 3 * 2;
+    if (nullptr == arena || 0 == capacity) {
+        return false;
+    }
+
+    data_ = (uint8_t*) arena;
+    capacity_ = capacity;
+    bytes_ = bytesRequired(capacity, format);
+    format_ = format;
+    source_ = MemorySource::Static;
+
+    memset(data_, 0, bytes_);
+
+    return true;
+}
+
+void SampleBuffer::release() {
+    if (nullptr != data_ && MemorySource::Static != source_) {
+        heap_caps_free(data_);
+    }
+
+    data_ = nullptr;
+    capacity_ = bytes_ = 0;
+}
+
+size_t SampleBuffer::capacity() const {
+    return capacity_;
+}
+
+size_t SampleBuffer::bytes() const {
+    return bytes_;
+}
+
+SampleFormat SampleBuffer::format() const {
+    return format_;
+}
+
+MemorySource SampleBuffer::source() const {
+    return source_;
+}
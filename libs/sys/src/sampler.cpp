@@ -0,0 +1,217 @@
+//
+// ADC Sampler
+//
+
+#include "sys/sampler.h"
+#include "sys/trace.h"
+
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include <cstring>
+
+#define TAG "sampler"
+
+using namespace sys;
+
+static const uint32_t POLL_TIMEOUT_MS = 100;    // sampler task wakeup to check for stop
+
+// ############################################################################
+// Construction
+// ############################################################################
+
+AdcSampler::AdcSampler() {}
+
+AdcSampler::~AdcSampler() {
+    stop();
+}
+
+// ############################################################################
+// Control
+// ############################################################################
+
+bool AdcSampler::start(adc1_channel_t channel, uint32_t sample_rate) {
+    return start(&channel, 1, sample_rate);
+}
+
+bool AdcSampler::start(const adc1_channel_t* channels, size_t count, uint32_t sample_rate) {
+    if (running_) {
+        stop();
+    }
+
+    if (nullptr == channels || 0 == count || count > MAX_CHANNELS) {
+        ESP_LOGE(TAG, "invalid channel list");
+        return false;
+    }
+
+    num_channels_ = count;
+    sample_rate_ = sample_rate;
+    memset(slots_, 0xff, sizeof(slots_));
+
+    adc_digi_pattern_config_t patterns[MAX_CHANNELS] = {};
+    uint32_t mask = 0;
+
+    for (size_t i = 0; i < count; i++) {
+        channels_[i] = channels[i];
+        slots_[channels[i] & 0xf] = (uint8_t) i;
+        mask |= (1u << channels[i]);
+
+        auto& pattern = patterns[i];
+        pattern.atten = ADC_ATTEN_DB_0;
+        pattern.channel = (uint8_t) channels[i];
+        pattern.unit = 0;                       // ADC1
+        pattern.bit_width = 12;
+    }
+
+    adc_digi_init_config_t init_config = {};
+    init_config.max_store_buf_size = BLOCK_SIZE * sizeof(adc_digi_output_data_t) * 4;
+    init_config.conv_num_each_intr = BLOCK_SIZE * sizeof(adc_digi_output_data_t);
+    init_config.adc1_chan_mask = mask;
+    init_config.adc2_chan_mask = 0;
+
+    if (ESP_OK != adc_digi_initialize(&init_config)) {
+        ESP_LOGE(TAG, "failed to initialize continuous mode");
+        return false;
+    }
+
+    adc_digi_configuration_t config = {};
+    config.conv_limit_en = true;
+    config.conv_limit_num = 250;
+    config.pattern_num = (uint32_t) count;
+    config.adc_pattern = patterns;
+    config.sample_freq_hz = sample_rate * (uint32_t) count;
+    config.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    config.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+
+    if (ESP_OK != adc_digi_controller_configure(&config) || ESP_OK != adc_digi_start()) {
+        ESP_LOGE(TAG, "failed to start sampling at %u Hz", (unsigned) sample_rate);
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    ring_.clear();
+    frame_pos_ = 0;
+    dropped_ = 0;
+    running_ = true;
+
+#ifndef SIMULATOR
+    TaskHandle_t handle = nullptr;
+    if (pdPASS != xTaskCreatePinnedToCore(taskEntry, "sampler", 4096, this, 10, &handle, 0)) {
+        ESP_LOGE(TAG, "failed to create sampler task");
+        running_ = false;
+        adc_digi_stop();
+        adc_digi_deinitialize();
+        return false;
+    }
+    task_ = handle;
+#endif
+
+    ESP_LOGI(TAG, "sampling %d channel(s) at %u Hz", (int) count, (unsigned) sample_rate);
+
+    return true;
+}
+
+void AdcSampler::stop() {
+    if (!running_) return;
+
+    running_ = false;
+
+    while (nullptr != task_) {
+        vTaskDelay(1);                          // sampler task exits within one poll
+    }
+
+    adc_digi_stop();
+    adc_digi_deinitialize();
+}
+
+// ############################################################################
+// Producer
+// ############################################################################
+
+void AdcSampler::taskEntry(void* arg) {
+    auto sampler = (AdcSampler*) arg;
+
+    while (sampler->running_) {
+        sampler->poll(POLL_TIMEOUT_MS);
+    }
+
+    sampler->task_ = nullptr;
+
+#ifndef SIMULATOR
+    vTaskDelete(nullptr);
+#endif
+}
+
+size_t AdcSampler::poll(uint32_t timeout_ms) {
+    TRACE_SCOPE("sampler.poll");
+
+    uint32_t length = 0;
+    auto result = adc_digi_read_bytes((uint8_t*) block_, sizeof(block_), &length, timeout_ms);
+    if (ESP_OK != result) {
+        return 0;
+    }
+
+    // assemble frames in channel order, a conversion out of sequence
+    // (lost in a DMA overflow) drops the incomplete frame
+
+    size_t count = 0;
+    for (size_t i = 0; i < length / sizeof(adc_digi_output_data_t); i++) {
+        const auto& sample = block_[i];
+        auto slot = slots_[sample.type1.channel];
+        if (slot != frame_pos_) {
+            frame_pos_ = 0;
+            if (0 != slot) continue;
+        }
+
+        frame_[frame_pos_++] = (uint16_t) sample.type1.data;
+
+        if (frame_pos_ == num_channels_) {
+            memcpy(&values_[count], frame_, num_channels_ * sizeof(uint16_t));
+            count += num_channels_;
+            frame_pos_ = 0;
+        }
+    }
+
+    // push whole frames only, the consumer stays aligned to channel 0
+
+    auto space = (ring_.capacity() - ring_.size()) / num_channels_ * num_channels_;
+    if (count > space) {
+        dropped_ = dropped_ + (uint32_t) (count - space);
+        count = space;
+    }
+
+    return ring_.push(values_, count);
+}
+
+// ############################################################################
+// Consumer
+// ############################################################################
+
+size_t AdcSampler::read(uint16_t* samples, size_t max_count) {
+#ifdef SIMULATOR
+    while (running_ && 0 != poll(0)) {}
+#endif
+
+    if (num_channels_ > 1) {
+        max_count -= max_count % num_channels_;
+    }
+
+    return ring_.pop(samples, max_count);
+}
+
+size_t AdcSampler::available() const {
+    return ring_.size();
+}
+
+size_t AdcSampler::channels() const {
+    return num_channels_;
+}
+
+uint32_t AdcSampler::sampleRate() const {
+    return sample_rate_;
+}
+
+uint32_t AdcSampler::dropped() const {
+    return ring_.dropped() + dropped_;
+}
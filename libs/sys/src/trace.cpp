@@ -0,0 +1,102 @@
+//
+// Trace
+//
+#include "sys/trace.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#define TAG "trace"
+
+using namespace sys;
+
+// statically allocated buffers, assigned to tasks on first use
+static TraceBuffer trace_buffers[TRACE_MAX_TASKS];
+static std::atomic<int> trace_buffer_count{0};
+
+int64_t Trace::now() {
+    return esp_timer_get_time();
+}
+
+TraceBuffer* Trace::buffer() {
+    static thread_local TraceBuffer* task_buffer = nullptr;
+
+    if (nullptr == task_buffer) {
+        int index = trace_buffer_count.fetch_add(1);
+        if (index >= TRACE_MAX_TASKS) {
+            trace_buffer_count.store(TRACE_MAX_TASKS);
+            return nullptr;
+        }
+        task_buffer = &trace_buffers[index];
+        task_buffer->task_id = index + 1;
+    }
+
+    return task_buffer;
+}
+
+void Trace::record(const char* name, int64_t start_us, uint32_t duration_us) {
+    auto buf = buffer();
+    if (nullptr == buf) return;
+
+    uint32_t head = buf->head.load(std::memory_order_relaxed);
+
+    auto& event = buf->events[head % TRACE_BUFFER_SIZE];
+    event.name = name;
+    event.start_us = start_us;
+    event.duration_us = duration_us;
+
+    buf->head.store(head + 1, std::memory_order_release);
+}
+
+void Trace::clear() {
+    int count = trace_buffer_count.load();
+    for (int i = 0; i < count && i < TRACE_MAX_TASKS; i++) {
+        trace_buffers[i].head.store(0, std::memory_order_release);
+    }
+}
+
+bool Trace::dump(FILE* file) {
+    if (nullptr == file) return false;
+
+    fprintf(file, "{\"traceEvents\":[\n");
+
+    bool first = true;
+
+    int count = trace_buffer_count.load();
+    for (int i = 0; i < count && i < TRACE_MAX_TASKS; i++) {
+        const auto& buf = trace_buffers[i];
+
+        uint32_t head = buf.head.load(std::memory_order_acquire);
+        uint32_t num_events = (head < TRACE_BUFFER_SIZE) ? head : TRACE_BUFFER_SIZE;
+
+        for (uint32_t j = head - num_events; j != head; j++) {
+            const auto& event = buf.events[j % TRACE_BUFFER_SIZE];
+            fprintf(file, "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%u,\"pid\":1,\"tid\":%d}",
+                    first ? "" : ",\n",
+                    event.name,
+                    (long long) event.start_us,
+                    (unsigned) event.duration_us,
+                    buf.task_id);
+            first = false;
+        }
+    }
+
+    fprintf(file, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+    return true;
+}
+
+bool Trace::save(const char* filename) {
+    FILE* file = fopen(filename, "w");
+    if (nullptr == file) {
+        ESP_LOGE(TAG, "failed to open trace file: %s", filename);
+        return false;
+    }
+
+    dump(file);
+    fclose(file);
+
+    ESP_LOGI(TAG, "trace written to %s", filename);
+
+    return true;
+}
@@ -2,51 +2,212 @@
 // Graphics Demo
 //
 
-#include "application/application.h"
+#include "application/scheduler.h"
 #include "driver/adc.h"
+#include "esp_timer.h"
 #include "graphics/graphics.h"
 #include "graphics/oscilloscope.h"
+#include "sys/sampler.h"
 
-class OscilloscopeDemo : public application::Application {
+class ScopeComponent : public application::Component {
    public:
-    explicit OscilloscopeDemo() : Application() {}
+    explicit ScopeComponent() : Component() {}
 
     void init() override {
+        oscilloscope_.init();
+        oscilloscope_.setChannels(2);                           // two inputs, interleaved
+        oscilloscope_.setChannelScale(0, 0.5f, 2048);           // upper half of the screen
+        oscilloscope_.setChannelScale(1, 0.5f, 0);              // lower half of the screen
+        oscilloscope_.setChannelStyle(1, graphics::TraceStyle::Dotted);
+        oscilloscope_.setTraceMode(graphics::TraceMode::PeakDetect);
+        oscilloscope_.setEnvelope(true, 1);                     // fading envelope of past traces
+        oscilloscope_.setHoldoff(2000);                         // at most 10 captures per second
+        oscilloscope_.setRollMode(graphics::RollMode::Sweep);   // roll mode draws new columns only
+
+        auto& spectrum = oscilloscope_.spectrum();
+        spectrum.setPoints(512);                                // 39 Hz per bin at 20 kHz
+        spectrum.setWindow(graphics::Window::Hann);
+        spectrum.setRange(-72);
+        spectrum.setPeakHold(3, 8);                             // fall 3 dB per spectrum, hold peaks
+        spectrum.setTimeBudget(2000);                           // spread the FFT over frames if needed
+
+        setAutoInvalidate(false);                               // redraw once per capture
+        setMode(MODE_TRIGGERED);
+
+        const adc1_channel_t channels[] = { ADC1_CHANNEL_4, ADC1_CHANNEL_5 };
+        sampler_.start(channels, 2, 20000);                     // scan both at 20 kHz in the background
+    }
 
-        setPeriod(40);
+    void setMode(int mode) {
+        if ((MODE_DEEP == mode) != oscilloscope_.isDeepMemory()) {
+            oscilloscope_.setDeepMemory((MODE_DEEP == mode) ? DEEP_FRAMES : 0,     // 24 KB while in use
+                                        sys::SampleFormat::Packed12, sys::MemorySource::Internal);
+        }
+
+        if (MODE_ROLL == mode) {
+            oscilloscope_.setTrigger(graphics::TriggerEdge::None, 0);
+            oscilloscope_.setSamplesPerColumn(200);             // 128 columns show 1.28 s
+        } else {
+            oscilloscope_.setTrigger(graphics::TriggerEdge::Rising, 3072, 32);  // mid level of channel 0
+            oscilloscope_.setSamplesPerColumn(4);               // 128 columns show 25.6 ms
+            oscilloscope_.setPreTrigger(PRE_TRIGGER);           // trigger point at a quarter of the screen
+        }
+
+        oscilloscope_.setView(MODE_SPECTRUM == mode ? graphics::ScopeView::Spectrum : graphics::ScopeView::Time);
+        setPartialRender(oscilloscope_.isIncremental());        // the scope marks its new columns itself
+        mode_ = mode;
+
+        if (MODE_DEEP == mode) {
+            oscilloscope_.setDeepView(0, DEEP_FRAMES / getWidth());  // whole capture first
+            oscilloscope_.arm();
+        }
+    }
 
-        channel_ = ADC1_CHANNEL_4;
-        adc1_config_width(ADC_WIDTH_12Bit);
-        adc1_config_channel_atten(channel_, ADC_ATTEN_0db);
+    void updateDeep() {
+        if (0 == oscilloscope_.getDeepLength() || getUpdateCounter() % ZOOM_FRAMES != 0) {
+            return;                                             // recording, or showing a zoom level
+        }
+
+        auto zoom = oscilloscope_.getDeepZoom();
+        if (zoom <= 1) {                                        // take the next capture
+            oscilloscope_.setDeepView(0, DEEP_FRAMES / getWidth());
+            oscilloscope_.arm();
+            return;
+        }
+
+        zoom /= 2;                                              // zoom in around the trigger point
+        size_t margin = zoom * getWidth() / 4;
+        oscilloscope_.setDeepView(PRE_TRIGGER > margin ? PRE_TRIGGER - margin : 0, zoom);
+        invalidate();
+    }
 
-        auto display = getDisplay();  // get display reference
-        display->clear();              // clear display
-        display->setBuiltinFont(1);
-        display->update(true);  // update display
+    size_t getWidth() const {
+        const auto& region = getRegion();
+        return (size_t) (region.right - region.left + 1);
+    }
+
+    void update() override {
+        size_t count;
+        while (0 != (count = sampler_.read(block_, BLOCK_SIZE))) {  // consume whole blocks per frame
+            oscilloscope_.add(block_, count);
+        }
+
+        if (getUpdateCounter() % VIEW_FRAMES == 0) {            // cycle through the modes
+            setMode((getUpdateCounter() / VIEW_FRAMES) % MODE_COUNT);
+            invalidate();
+        }
+
+        if (MODE_DEEP == mode_) {
+            updateDeep();
+        }
+
+        if (MODE_ROLL == mode_ || oscilloscope_.takeNewCapture() || oscilloscope_.process()) {
+            invalidate();
+        }
+    }
 
-        oscilloscope.init();
+    void render() override {
+        auto display = getDisplay();
+        const auto& region = getRegion();
+        oscilloscope_.draw(display, region.left, region.top, region.right, region.bottom, false, 0, 0);
     }
 
-    void update() override  {
+    int getValue(size_t channel) const {
+        return oscilloscope_.getValue(channel);
+    }
 
-        auto display = getDisplay();  // get display reference
+    bool isSpectrumView() const {
+        return graphics::ScopeView::Spectrum == oscilloscope_.getView();
+    }
 
-        display->clear();  // clear display (ignore locked areas)
+    int getPeakFrequency() {
+        auto& spectrum = oscilloscope_.spectrum();
+        return (int) ((int64_t) spectrum.getPeakBin() * sampler_.sampleRate() / spectrum.getPoints());
+    }
 
-        int top = display->font()->height + 2;
+   private:
+    static const size_t BLOCK_SIZE = 256;
+    static const uint32_t VIEW_FRAMES = 125;                    // 5 seconds per mode
+
+    static const int MODE_TRIGGERED = 0;
+    static const int MODE_ROLL = 1;
+    static const int MODE_SPECTRUM = 2;
+    static const int MODE_DEEP = 3;
+    static const int MODE_COUNT = 4;
+
+    static const size_t PRE_TRIGGER = 128;                      // samples before the trigger point
+    static const size_t DEEP_FRAMES = 8192;                     // 410 ms of both channels
+    static const uint32_t ZOOM_FRAMES = 12;                     // show each zoom level for 480 ms
+
+    int mode_{MODE_TRIGGERED};
+
+    sys::AdcSampler sampler_;
+    uint16_t block_[BLOCK_SIZE];
+    graphics::Oscilloscope oscilloscope_;
+
+    _NODEFAULTS(ScopeComponent)
+};
+
+class StatusBar : public application::Component {
+   public:
+    explicit StatusBar(ScopeComponent* scope) : Component(), scope_(scope) {}
+
+    void update() override {
+        seconds_ = (uint32_t) (esp_timer_get_time() / 1000000);
+    }
+
+    void render() override {
+        auto display = getDisplay();
+        const auto& region = getRegion();
+
+        graphics::TextBuffer<32> text;
+        if (scope_->isSpectrumView()) {
+            text.append("PEAK: ").appendInt(scope_->getPeakFrequency()).append(" Hz");
+        } else {
+            text.append("A:").appendInt(scope_->getValue(0)).append(" B:").appendInt(scope_->getValue(1));
+        }
+        display->drawString(region.left + 2, region.top + 1, text.c_str(), text.length());
+
+        text.clear();
+        text.appendUnsigned((seconds_ / 60) % 100, 2, '0').append(':').appendUnsigned(seconds_ % 60, 2, '0');
+        display->drawString(region.right - display->measureString(text.c_str(), text.length()) - 1, region.top + 1,
+                            text.c_str(), text.length());
+
+        display->drawHorizontalLine(region.left, region.bottom, region.right);
+    }
+
+   private:
+    ScopeComponent* scope_{nullptr};
+    uint32_t seconds_{0};
 
-        display->drawHorizontalLine(0, top-1, display->width()-1);
+    _NODEFAULTS(StatusBar)
+};
+
+class OscilloscopeDemo : public application::Scheduler {
+   public:
+    explicit OscilloscopeDemo() : Scheduler(), status_(&scope_) {}
+
+    void init() override {
+
+        auto display = getDisplay();  // get display reference
+        display->clear();              // clear display
+        display->setBuiltinFont(1);
+        display->update(true);  // update display
+
+        int top = display->font()->height + 2;
 
-        int value = adc1_get_raw(channel_);
-        oscilloscope.add(value);
-        oscilloscope.draw(display, 0, top, display->width()-1, display->height()-1, true, 2, 1);
+        scope_.setPeriod(40);                                           // draw at 25 Hz
+        scope_.setRegion(0, top, display->width()-1, display->height()-1);
+        addComponent(&scope_);
 
-        display->update(true);  // refresh display
+        status_.setPeriod(500);                                         // low-rate status line
+        status_.setRegion(0, 0, display->width()-1, top-1);
+        addComponent(&status_);
     }
 
    private:
-    adc1_channel_t channel_;
-    graphics::Oscilloscope oscilloscope;
+    ScopeComponent scope_;
+    StatusBar status_;
 
     _NODEFAULTS(OscilloscopeDemo)
 };
@@ -6,6 +6,7 @@
 
 #include "application/application.h"
 #include "graphics/graphics.h"
+#include "sys/trace.h"
 
 #include "./bitmaps.inc"
 
@@ -62,6 +63,7 @@ class RetroDemo : public application::Application {
         }
 
         void drawScroller() {
+            TRACE_SCOPE("retro.scroller");
             auto display = getDisplay();
             auto delta = this->getDelta();
             auto start = scroll_text.c_str() + scroll_char_;
@@ -100,6 +102,7 @@ class RetroDemo : public application::Application {
         }
 
         void drawZoomed() {
+            TRACE_SCOPE("retro.zoom");
             auto delta = this->getDelta();
 
             const float speed = 10.0f;
@@ -150,6 +153,7 @@ class RetroDemo : public application::Application {
         }
 
         void drawBars() {
+            TRACE_SCOPE("retro.bars");
 
             auto display = getDisplay();
             auto delta = this->getDelta();
@@ -203,6 +207,7 @@ class RetroDemo : public application::Application {
         }
 
         void drawParticles() {
+            TRACE_SCOPE("retro.particles");
 
             auto display = getDisplay();
             auto delta = this->getDelta();
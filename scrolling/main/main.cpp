@@ -3,6 +3,7 @@
 //
 
 #include <cmath>
+#include <cstring>
 
 #include "application/application.h"
 #include "graphics/graphics.h"
@@ -11,11 +12,76 @@ const char* LABEL_TOP = "ESP32 HACKS";
 const char* LABEL_MID = "Hello, world!";
 const char* LABEL_BOTTOM = "Scroll Demo";
 
+// 8x8 tiles in page format (one byte per column, bit 0 is the top row)
+const uint8_t TILES[] = {
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,     // empty
+    0x1f, 0x11, 0x11, 0x11, 0xf1, 0x11, 0x11, 0x11,     // bricks
+    0xff, 0x81, 0x81, 0x99, 0x99, 0x81, 0x81, 0xff,     // box
+    0x3c, 0x7e, 0xff, 0xff, 0xff, 0xff, 0x7e, 0x3c,     // ball
+    0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80,     // slope
+    0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55, 0xaa, 0x55      // checker
+};
+
+const int NUM_TILES = sizeof(TILES) / graphics::TileMap::TILE_SIZE;
+const int MAP_WIDTH = 32;
+const int MAP_HEIGHT = 16;
+
+const char* CREDITS[] = {
+    "", "", "", "", "", "", "", "",
+    "ESP32 HACKS",
+    "",
+    "Vertical scrolling",
+    "with the display",
+    "start line",
+    "",
+    "One page is sent",
+    "per scroll step",
+    "",
+    "SSD1306 128x64",
+    "", "", ""
+};
+
+const int NUM_CREDITS = sizeof(CREDITS) / sizeof(CREDITS[0]);
+
+/**
+ * Credits text, one line per content page
+ */
+class CreditsScroller : public graphics::VerticalScroller {
+    public:
+        CreditsScroller() : line_(graphics::VerticalScroller::MAX_WIDTH, 8) {}
+
+        void init(graphics::Display* display) {
+            display_ = display;
+        }
+
+    protected:
+        void renderPage(uint8_t* dest, int width, int index) override {
+            auto str = CREDITS[((index % NUM_CREDITS) + NUM_CREDITS) % NUM_CREDITS];
+
+            auto previous = display_->setLayer(&line_);         // draw text offscreen
+            line_.clear();
+            display_->drawString((width - display_->measureString(str)) / 2, 0, str);
+            display_->setLayer(previous);
+
+            memcpy(dest, line_.buffer(), width);
+        }
+
+    private:
+        graphics::Display* display_{nullptr};
+        graphics::Layer line_;
+};
+
 class ScrollingDemo : public application::Application {
    public:
     explicit ScrollingDemo() : Application() {}
 
     void init() {
+        createMap();
+        credits_.init(getDisplay());
+        drawLabels();
+    }
+
+    void drawLabels() {
         auto display = getDisplay();
         display->clear();
 
@@ -57,9 +123,72 @@ class ScrollingDemo : public application::Application {
             display->startDiagonalScrolling(scroll_start_page_, scroll_end_page, scroll_y0_+1, scroll_y1_-1, true, scroll_speed_, 1);    // scroll right and vertical
         } else if (step_frames_*3 == animation_counter_) {
             display->startDiagonalScrolling(scroll_start_page_, scroll_end_page, scroll_y0_+1, scroll_y1_-1, false, scroll_speed_, 1);  // scroll left and vertical
+        } else if (step_frames_*4 == animation_counter_) {
+            display->stopScrolling();
+            drawLabels();                                       // restore scrolled content
+            playfield_.setHardwareScroll(false);
+            playfield_.setViewport(0, display->width()-1, playfield_first_page_, playfield_last_page_);
+        } else if (step_frames_*5 == animation_counter_) {
+            playfield_.setHardwareScroll(true);                 // full screen, start line ring buffer
+        } else if (step_frames_*6 == animation_counter_) {
+            display->setBuiltinFont(0);
+            credits_.setPosition(0);
+            credits_.invalidate();
+        }
+
+        if (animation_counter_ >= (uint32_t) step_frames_*6) {
+            credits_.scroll(1);                                 // one page transfer per step
+            credits_.update(display->device());
+        } else if (animation_counter_ >= (uint32_t) step_frames_*4) {
+            updatePlayfield();
+        }
+
+        animation_counter_ = (animation_counter_ + 1) % (step_frames_ * 7);
+
+        if (0 == animation_counter_) {
+            display->device()->setVerticalOffset(0);
+            drawLabels();
+        }
+    }
+
+    void updatePlayfield() {
+        auto display = getDisplay();
+        auto t = (float) animation_counter_ * 0.02f;
+
+        if (playfield_.isHardwareScroll()) {
+            // vertical scrolling only: just the rows scrolled into view are drawn and sent
+            playfield_.setCamera(playfield_.cameraX(), playfield_.cameraY() + 1);
+        } else {
+            // software camera with sub-page vertical offset
+            playfield_.setCamera((int) (t * 40.0f), (int) (24.0f + 24.0f * std::sin(t)));
+        }
+
+        playfield_.draw(display->device());
+        display->update();
+    }
+
+    void createMap() {
+        for (int y = 0; y < MAP_HEIGHT; y++) {
+            for (int x = 0; x < MAP_WIDTH; x++) {
+                uint8_t index = 0;
+                if (y == MAP_HEIGHT - 1 || (y % 5 == 4 && (x / 4) % 3 != 0)) {
+                    index = 1;                                  // floors
+                } else if ((x * 7 + y * 3) % 17 == 0) {
+                    index = 2;
+                } else if ((x * 5 + y * 11) % 23 == 0) {
+                    index = 3;
+                } else if (y % 5 == 3 && x % 12 == 2) {
+                    index = 4;
+                } else if (y % 5 == 3 && x % 12 == 7) {
+                    index = 5;
+                }
+                map_[y * MAP_WIDTH + x] = index;
+            }
         }
 
-        animation_counter_ = (animation_counter_ + 1) % (step_frames_ * 4);
+        playfield_.setTiles(TILES, NUM_TILES);
+        playfield_.setMap(map_, MAP_WIDTH, MAP_HEIGHT);
+        playfield_.setWrap(true);
     }
 
    private:
@@ -76,6 +205,11 @@ class ScrollingDemo : public application::Application {
     const int scroll_start_page_{1};
     const int scroll_end_page{6};
     const int step_frames_{400};
+    const int playfield_first_page_{2};
+    const int playfield_last_page_{5};
+    uint8_t map_[MAP_WIDTH * MAP_HEIGHT];
+    graphics::TileMap playfield_;
+    CreditsScroller credits_;
     int scroll_y0_{0};
     int scroll_y1_{0};
 
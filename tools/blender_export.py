@@ -4,6 +4,17 @@
 
 import bpy
 import os
+import math
+import heapq
+
+# Level of detail generation
+LOD_RATIOS = [0.5, 0.25, 0.125]     # triangle ratio per additional level (max. 3 extra levels)
+LOD_MIN_TRIANGLES = 16              # do not generate levels below this triangle count
+LOD_PIXELS_PER_TRIANGLE = 6.0       # min. projected pixels per visible triangle before switching
+
+# Keyframe animation
+ANIM_FRAME_STEP = 2                 # sample every n-th scene frame
+ANIM_LOOP = True                    # wrap from the last to the first keyframe
 
 output_buffer = ""
 
@@ -18,11 +29,444 @@ def write(txt):
     print(txt, end='')
     output_buffer += txt
 
+################################################################################
+# Quadric error metrics decimation (Garland/Heckbert)
+################################################################################
+
+def plane_quadric(p0, p1, p2):
+    ux, uy, uz = p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2]
+    vx, vy, vz = p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2]
+    nx, ny, nz = uy*vz - uz*vy, uz*vx - ux*vz, ux*vy - uy*vx
+    l = math.sqrt(nx*nx + ny*ny + nz*nz)
+    if l == 0.0:
+        return [0.0] * 10
+    nx, ny, nz = nx/l, ny/l, nz/l
+    d = -(nx*p0[0] + ny*p0[1] + nz*p0[2])
+    # upper triangle of symmetric 4x4 matrix: aa ab ac ad bb bc bd cc cd dd
+    return [nx*nx, nx*ny, nx*nz, nx*d, ny*ny, ny*nz, ny*d, nz*nz, nz*d, d*d]
+
+def quadric_add(a, b):
+    return [a[i] + b[i] for i in range(10)]
+
+def quadric_error(q, v):
+    x, y, z = v
+    return (q[0]*x*x + 2*q[1]*x*y + 2*q[2]*x*z + 2*q[3]*x +
+            q[4]*y*y + 2*q[5]*y*z + 2*q[6]*y +
+            q[7]*z*z + 2*q[8]*z +
+            q[9])
+
+def quadric_optimum(q, p1, p2):
+    # solve the 3x3 system for the error minimum, fall back to end/mid points
+    a = [[q[0], q[1], q[2]], [q[1], q[4], q[5]], [q[2], q[5], q[7]]]
+    b = [-q[3], -q[6], -q[8]]
+    det = (a[0][0]*(a[1][1]*a[2][2] - a[1][2]*a[2][1]) -
+           a[0][1]*(a[1][0]*a[2][2] - a[1][2]*a[2][0]) +
+           a[0][2]*(a[1][0]*a[2][1] - a[1][1]*a[2][0]))
+    candidates = [p1, p2, tuple((p1[i] + p2[i]) * 0.5 for i in range(3))]
+    if abs(det) > 1e-9:
+        def col(m, i, c):
+            return [[c[r] if k == i else m[r][k] for k in range(3)] for r in range(3)]
+        def det3(m):
+            return (m[0][0]*(m[1][1]*m[2][2] - m[1][2]*m[2][1]) -
+                    m[0][1]*(m[1][0]*m[2][2] - m[1][2]*m[2][0]) +
+                    m[0][2]*(m[1][0]*m[2][1] - m[1][1]*m[2][0]))
+        candidates.append(tuple(det3(col(a, i, b)) / det for i in range(3)))
+    best = min(candidates, key=lambda v: quadric_error(q, v))
+    return best, quadric_error(q, best)
+
+def triangulate(polygons):
+    triangles = []
+    for f in polygons:
+        for i in range(1, len(f) - 1):
+            triangles.append((f[0], f[i], f[i+1]))
+    return triangles
+
+def decimate(vertices, triangles, target_count):
+    positions = [tuple(v) for v in vertices]
+    tris = [list(t) for t in triangles]
+    alive = [True] * len(tris)
+    alive_count = len(tris)
+
+    quadrics = [[0.0] * 10 for _ in positions]
+    vertex_tris = [set() for _ in positions]
+    for ti, t in enumerate(tris):
+        q = plane_quadric(positions[t[0]], positions[t[1]], positions[t[2]])
+        for vi in t:
+            quadrics[vi] = quadric_add(quadrics[vi], q)
+            vertex_tris[vi].add(ti)
+
+    version = [0] * len(positions)
+    heap = []
+
+    def push_edge(a, b):
+        if a > b:
+            a, b = b, a
+        q = quadric_add(quadrics[a], quadrics[b])
+        v, err = quadric_optimum(q, positions[a], positions[b])
+        heapq.heappush(heap, (err, a, b, version[a], version[b], v))
+
+    edges = set()
+    for t in tris:
+        for i in range(3):
+            a, b = t[i], t[(i+1) % 3]
+            edges.add((min(a, b), max(a, b)))
+    for a, b in edges:
+        push_edge(a, b)
+
+    while alive_count > target_count and heap:
+        err, a, b, va, vb, v = heapq.heappop(heap)
+        if va != version[a] or vb != version[b]:
+            continue  # outdated entry
+
+        # collapse b into a
+        positions[a] = v
+        quadrics[a] = quadric_add(quadrics[a], quadrics[b])
+        version[a] += 1
+        version[b] += 1
+
+        for ti in list(vertex_tris[b]):
+            t = tris[ti]
+            t[t.index(b)] = a
+            if t[0] == t[1] or t[1] == t[2] or t[0] == t[2]:
+                alive[ti] = False
+                alive_count -= 1
+                for vi in t:
+                    vertex_tris[vi].discard(ti)
+            else:
+                vertex_tris[a].add(ti)
+        vertex_tris[b] = set()
+
+        neighbours = set()
+        for ti in vertex_tris[a]:
+            neighbours.update(tris[ti])
+        neighbours.discard(a)
+        for n in neighbours:
+            push_edge(a, n)
+
+    # compact vertex list
+    remap = {}
+    out_vertices = []
+    out_triangles = []
+    for ti, t in enumerate(tris):
+        if not alive[ti]:
+            continue
+        face = []
+        for vi in t:
+            if vi not in remap:
+                remap[vi] = len(out_vertices)
+                out_vertices.append(positions[vi])
+            face.append(remap[vi])
+        out_triangles.append(tuple(face))
+
+    return out_vertices, out_triangles
+
+def max_radius_for(triangle_count):
+    # about half of the triangles face the viewer and share the projected disc area
+    return math.sqrt(LOD_PIXELS_PER_TRIANGLE * triangle_count / (2.0 * math.pi))
+
+def generate_levels(vertices, polygons):
+    triangles = triangulate(polygons)
+    levels = []
+    finer_count = len(triangles)
+    for ratio in LOD_RATIOS:
+        target = int(len(triangles) * ratio)
+        if target < LOD_MIN_TRIANGLES:
+            break
+        level_vertices, level_triangles = decimate(vertices, triangles, target)
+        if len(level_triangles) >= finer_count:
+            break
+        levels.append((level_vertices, level_triangles, max_radius_for(finer_count)))
+        finer_count = len(level_triangles)
+    return levels
+
+################################################################################
+# Compact format: quantization and triangle strips
+################################################################################
+
+def quantization(point_sets, uniform=False):
+    # per-axis scale and bias covering all given point sets (base mesh and morph frames)
+    scale = []
+    bias = []
+    for axis in range(3):
+        lo = min(v[axis] for points in point_sets for v in points)
+        hi = max(v[axis] for points in point_sets for v in points)
+        bias.append((lo + hi) * 0.5)
+        half_range = (hi - lo) * 0.5
+        scale.append(half_range / 32767.0 if half_range > 0.0 else 1.0)
+    if uniform:
+        # bone rotations need the same scale on all axes
+        max_scale = max(scale[axis] if scale[axis] != 1.0 else 0.0 for axis in range(3)) or 1.0
+        scale = [max_scale] * 3
+    return scale, bias
+
+def quantize_positions(vertices, scale, bias):
+    positions = []
+    for v in vertices:
+        positions.append(tuple(int(round((v[axis] - bias[axis]) / scale[axis])) for axis in range(3)))
+    return positions
+
+def quantize(vertices):
+    scale, bias = quantization([vertices])
+    return quantize_positions(vertices, scale, bias), scale, bias
+
+def stripify(triangles):
+    # greedy stripification, triangle k of a strip uses (s[k], s[k+1], s[k+2]) for even k
+    # and (s[k+1], s[k], s[k+2]) for odd k to keep the original winding order
+    edge_map = {}
+    for ti, t in enumerate(triangles):
+        for r in range(3):
+            edge_map.setdefault((t[r], t[(r+1) % 3]), []).append((ti, t[(r+2) % 3]))
+
+    used = [False] * len(triangles)
+
+    def next_triangle(a, b):
+        for ti, c in edge_map.get((a, b), []):
+            if not used[ti]:
+                return ti, c
+        return None
+
+    def grow(start, rotation, commit):
+        t = triangles[start]
+        strip = [t[rotation], t[(rotation+1) % 3], t[(rotation+2) % 3]]
+        taken = [start]
+        if commit:
+            used[start] = True
+        while True:
+            k = len(strip) - 2      # index of the next triangle
+            if k & 1:
+                candidate = next_triangle(strip[-1], strip[-2])
+            else:
+                candidate = next_triangle(strip[-2], strip[-1])
+            if candidate is None or candidate[0] in taken:
+                break
+            ti, c = candidate
+            taken.append(ti)
+            if commit:
+                used[ti] = True
+            strip.append(c)
+        return strip
+
+    strips = []
+    for ti in range(len(triangles)):
+        if used[ti]:
+            continue
+        best = max(range(3), key=lambda r: len(grow(ti, r, False)))
+        strips.append(grow(ti, best, True))
+
+    return strips
+
+def write_packed(name, vertices, polygons, scale=None, bias=None, radius=None):
+    if scale is None:
+        positions, scale, bias = quantize(vertices)
+    else:
+        positions = quantize_positions(vertices, scale, bias)
+    strips = stripify(triangulate(polygons))
+    if radius is None:
+        radius = max(math.sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]) for v in vertices)
+
+    if len(vertices) < 0xff:
+        index_type, restart = 'uint8_t', 0xff
+    else:
+        index_type, restart = 'uint16_t', 0xffff
+
+    indices = []
+    for strip in strips:
+        if indices:
+            indices.append(restart)
+        indices.extend(strip)
+
+    writeLn(f'static constexpr int16_t {name}_positions[] = {{')
+    for i, q in enumerate(positions):
+        write(f'    {q[0]}, {q[1]}, {q[2]}')
+        writeLn(',') if i != len(positions) - 1 else writeLn('')
+    writeLn('};\n')
+
+    writeLn(f'static constexpr {index_type} {name}_indices[] = {{')
+    for i in range(0, len(indices), 16):
+        chunk = indices[i:i+16]
+        write('    ' + ', '.join(str(x) for x in chunk))
+        writeLn(',') if i + 16 < len(indices) else writeLn('')
+    writeLn('};\n')
+
+    indices8 = f'{name}_indices' if index_type == 'uint8_t' else 'nullptr'
+    indices16 = f'{name}_indices' if index_type == 'uint16_t' else 'nullptr'
+
+    writeLn(f'static constexpr graphics::PackedMesh {name} {{')
+    writeLn(f'    {name}_positions, {len(positions)},')
+    writeLn(f'    {indices8}, {indices16}, {len(indices)},')
+    writeLn(f'    {{ {scale[0]!r}f, {scale[1]!r}f, {scale[2]!r}f }},')
+    writeLn(f'    {{ {bias[0]!r}f, {bias[1]!r}f, {bias[2]!r}f }},')
+    writeLn(f'    {radius!r}f')
+    writeLn('};\n')
+
+################################################################################
+# Keyframe animation: morph targets and rigid single bone skinning
+################################################################################
+
+ROTATION_ONE = 1 << 14  # Q14
+
+def bind_bones(obj, armature):
+    # bind every vertex to its strongest bone, unbound vertices get an identity bone
+    bone_names = []
+    vertex_bones = []
+    for v in obj.data.vertices:
+        best = None
+        for g in v.groups:
+            name = obj.vertex_groups[g.group].name
+            if name in armature.data.bones and (best is None or g.weight > best[1]):
+                best = (name, g.weight)
+        name = best[0] if best else None
+        if name not in bone_names:
+            bone_names.append(name)
+        vertex_bones.append(bone_names.index(name))
+    return bone_names, vertex_bones
+
+def morph_positions(shape_keys):
+    basis = shape_keys.reference_key
+    positions = []
+    for i, v in enumerate(basis.data):
+        p = [v.co.x, v.co.y, v.co.z]
+        for kb in shape_keys.key_blocks:
+            if kb == basis or kb.mute or kb.value == 0.0:
+                continue
+            co = kb.data[i].co
+            p[0] += kb.value * (co.x - v.co.x)
+            p[1] += kb.value * (co.y - v.co.y)
+            p[2] += kb.value * (co.z - v.co.z)
+        positions.append(tuple(p))
+    return positions
+
+def bone_poses(obj, armature, bone_names):
+    to_armature = armature.matrix_world.inverted() @ obj.matrix_world
+    from_armature = to_armature.inverted()
+    poses = []
+    for name in bone_names:
+        if name is None:
+            poses.append((((1.0, 0.0, 0.0), (0.0, 1.0, 0.0), (0.0, 0.0, 1.0)), (0.0, 0.0, 0.0)))
+            continue
+        pose_bone = armature.pose.bones[name]
+        m = from_armature @ pose_bone.matrix @ pose_bone.bone.matrix_local.inverted() @ to_armature
+        loc, rot, _ = m.decompose()   # rigid: drop bone scale
+        r = rot.to_matrix()
+        poses.append((tuple(tuple(r[row]) for row in range(3)), (loc.x, loc.y, loc.z)))
+    return poses
+
+def sample_animation(obj):
+    scene = bpy.context.scene
+    shape_keys = obj.data.shape_keys
+    has_morph = shape_keys is not None and len(shape_keys.key_blocks) > 1
+    armature = obj.find_armature()
+    if not has_morph and armature is None:
+        return None
+
+    frames = list(range(scene.frame_start, scene.frame_end + 1, ANIM_FRAME_STEP))
+    if len(frames) < 2:
+        return None
+
+    bone_names, vertex_bones = bind_bones(obj, armature) if armature else (None, None)
+    if bone_names is not None and len(bone_names) > 32:
+        print('too many bones, skipping bone animation')
+        bone_names, vertex_bones = None, None
+
+    morph_frames = [] if has_morph else None
+    bone_frames = [] if bone_names else None
+
+    current_frame = scene.frame_current
+    for frame in frames:
+        scene.frame_set(frame)
+        if has_morph:
+            morph_frames.append(morph_positions(shape_keys))
+        if bone_names:
+            bone_frames.append(bone_poses(obj, armature, bone_names))
+    scene.frame_set(current_frame)
+
+    if morph_frames is None and bone_frames is None:
+        return None
+
+    fps = scene.render.fps / scene.render.fps_base
+    return {
+        'morph_frames': morph_frames,
+        'vertex_bones': vertex_bones,
+        'bone_frames': bone_frames,
+        'frame_duration': ANIM_FRAME_STEP / fps
+    }
+
+def animated_radius(vertices, animation):
+    # bounding radius over all keyframes
+    radius = 0.0
+    frame_count = len(animation['morph_frames'] or animation['bone_frames'])
+    for frame in range(frame_count):
+        positions = animation['morph_frames'][frame] if animation['morph_frames'] else vertices
+        for i, p in enumerate(positions):
+            if animation['bone_frames']:
+                r, t = animation['bone_frames'][frame][animation['vertex_bones'][i]]
+                p = tuple(r[row][0]*p[0] + r[row][1]*p[1] + r[row][2]*p[2] + t[row] for row in range(3))
+            radius = max(radius, math.sqrt(p[0]*p[0] + p[1]*p[1] + p[2]*p[2]))
+    return radius
+
+def quantize_pose(pose, scale, bias):
+    # q' = R q + (R b + t - b) / s, requires uniform scale
+    r, t = pose
+    rotation = [max(-32767, min(32767, int(round(r[row][col] * ROTATION_ONE)))) for row in range(3) for col in range(3)]
+    translation = []
+    for row in range(3):
+        rb = r[row][0]*bias[0] + r[row][1]*bias[1] + r[row][2]*bias[2]
+        translation.append(int(round((rb + t[row] - bias[row]) / scale[row])))
+    return rotation, translation
+
+def write_animation(name, animation, scale, bias):
+    morph_frames = animation['morph_frames']
+    bone_frames = animation['bone_frames']
+
+    if morph_frames:
+        writeLn(f'static constexpr int16_t {name}_morph_frames[] = {{')
+        for f, positions in enumerate(morph_frames):
+            quantized = quantize_positions(positions, scale, bias)
+            for i, q in enumerate(quantized):
+                write(f'    {q[0]}, {q[1]}, {q[2]}')
+                writeLn(',') if f != len(morph_frames) - 1 or i != len(quantized) - 1 else writeLn('')
+        writeLn('};\n')
+
+    if bone_frames:
+        vertex_bones = animation['vertex_bones']
+        writeLn(f'static constexpr uint8_t {name}_vertex_bones[] = {{')
+        for i in range(0, len(vertex_bones), 16):
+            write('    ' + ', '.join(str(x) for x in vertex_bones[i:i+16]))
+            writeLn(',') if i + 16 < len(vertex_bones) else writeLn('')
+        writeLn('};\n')
+
+        writeLn(f'static constexpr graphics::BonePose {name}_bone_frames[] = {{')
+        for f, poses in enumerate(bone_frames):
+            for i, pose in enumerate(poses):
+                rotation, translation = quantize_pose(pose, scale, bias)
+                write('    { { ' + ', '.join(str(x) for x in rotation) + ' }, { ' + ', '.join(str(x) for x in translation) + ' } }')
+                writeLn(',') if f != len(bone_frames) - 1 or i != len(poses) - 1 else writeLn('')
+        writeLn('};\n')
+
+    morph_data = f'{name}_morph_frames' if morph_frames else 'nullptr'
+    bones_data = f'{name}_vertex_bones, {name}_bone_frames' if bone_frames else 'nullptr, nullptr'
+    num_bones = len(bone_frames[0]) if bone_frames else 0
+    loop = 'true' if ANIM_LOOP else 'false'
+
+    writeLn(f'static constexpr graphics::MeshAnimation {name} {{')
+    writeLn(f'    {morph_data}, {len(morph_frames) if morph_frames else 0},')
+    writeLn(f'    {bones_data}, {len(bone_frames) if bone_frames else 0}, {num_bones},')
+    writeLn(f'    {animation["frame_duration"]!r}f, {loop}')
+    writeLn('};\n')
+
+################################################################################
+# Export
+################################################################################
+
 def export_current_object():
 
     global output_buffer
 
-    obdata = bpy.context.object.data
+    obj = bpy.context.object
+    obdata = obj.data
+
+    vertices = [(v.co.x, v.co.y, v.co.z) for v in obdata.vertices]
+    faces = [tuple(f.vertices) for f in obdata.polygons if len(f.vertices) in (3, 4)]
 
     writeLn('////////////////////////////////////////////////////////////////////////////////')
     writeLn('// Mesh data')
@@ -30,22 +474,35 @@ def export_current_object():
     writeLn('// clang-format off')
     writeLn('////////////////////////////////////////////////////////////////////////////////\n')
 
-    writeLn('static const std::vector<graphics::Vertex> vertices {')
-    for v in obdata.vertices:
-        write(f'    {{ {v.co.x}, {v.co.y}, {v.co.z} }}')
-        writeLn(',') if v != obdata.vertices[-1] else writeLn('')
-    writeLn('};\n')
+    levels = generate_levels(vertices, faces)
 
-    writeLn('static const std::vector<graphics::Face> faces {')
-    for f in obdata.polygons:
-        if len(f.vertices) == 3:
-            write(f'    {{ {f.vertices[0]}, {f.vertices[1]}, {f.vertices[2]} }}')
-        elif len(f.vertices) == 4:
-            write(f'    {{ {f.vertices[0]}, {f.vertices[1]}, {f.vertices[2]}, {f.vertices[3]} }}')
-        else:
-            continue
-        writeLn(',') if f != obdata.polygons[-1] else writeLn('')
-    writeLn('};')
+    animation = sample_animation(obj)
+
+    if animation:
+        point_sets = [vertices] + (animation['morph_frames'] or [])
+        scale, bias = quantization(point_sets, uniform=animation['bone_frames'] is not None)
+        write_packed('mesh_data', vertices, faces, scale, bias, animated_radius(vertices, animation))
+        write_animation('mesh_animation', animation, scale, bias)
+    else:
+        write_packed('mesh_data', vertices, faces)
+    for i, (level_vertices, level_faces, _) in enumerate(levels):
+        write_packed(f'mesh_data_lod{i+1}', level_vertices, level_faces)
+
+    if levels:
+        writeLn('static constexpr graphics::MeshLevel levels[] = {')
+        for i, (_, _, max_radius) in enumerate(levels):
+            write(f'    {{ &mesh_data_lod{i+1}, {max_radius:.1f}f }}')
+            writeLn(',') if i != len(levels) - 1 else writeLn('')
+        writeLn('};')
+        writeLn('static constexpr size_t num_levels = sizeof(levels) / sizeof(levels[0]);')
+    else:
+        writeLn('static constexpr const graphics::MeshLevel* levels = nullptr;')
+        writeLn('static constexpr size_t num_levels = 0;')
+
+    if animation:
+        writeLn('static constexpr const graphics::MeshAnimation* animation = &mesh_animation;')
+    else:
+        writeLn('static constexpr const graphics::MeshAnimation* animation = nullptr;')
 
     document_path = os.path.expanduser('~/Documents')
     out_file = document_path + '/mesh.inc'